@@ -5,6 +5,7 @@
 #include "classes/Othello.h"
 #include "classes/Connect4.h"
 #include "classes/Chess.h"
+#include "classes/MoveGen.h"
 
 namespace ClassGame {
         //
@@ -78,6 +79,7 @@ namespace ClassGame {
                     ImGui::Text("Current Board State: %s", game->stateString().c_str());
 
                     if (Chess* chess = dynamic_cast<Chess*>(game)) {
+                        ImGui::Text("FEN: %s", chess->fen().c_str());
                         ImGui::Separator();
                         bool aiEnabled = chess->isAIEnabled();
                         if (ImGui::Button(aiEnabled ? "Stop Chess AI" : "Let Chess AI Play")) {
@@ -96,6 +98,100 @@ namespace ClassGame {
                         if (ImGui::Button(aiColor == 1 ? "AI plays Black (selected)" : "Set AI to Black")) {
                             chess->setPreferredAIColor(1);
                         }
+
+                        static const int hashSizes[] = { 1, 4, 16, 64, 256, 1024 };
+                        int hashMegabytes = static_cast<int>(chess->hashMegabytes());
+                        if (ImGui::BeginCombo("Hash (MB)", std::to_string(hashMegabytes).c_str())) {
+                            for (int size : hashSizes) {
+                                if (ImGui::Selectable(std::to_string(size).c_str(), size == hashMegabytes)) {
+                                    chess->setHashMegabytes(size);
+                                }
+                            }
+                            ImGui::EndCombo();
+                        }
+
+                        int moveTime = chess->moveTime();
+                        if (ImGui::SliderInt("Think time (ms)", &moveTime, 100, 10000)) {
+                            chess->setMoveTime(moveTime);
+                        }
+
+                        int lines = chess->multiPV();
+                        if (ImGui::SliderInt("Lines", &lines, 1, 5)) {
+                            chess->setMultiPV(lines);
+                        }
+
+                        bool ponder = chess->ponderEnabled();
+                        if (ImGui::Checkbox("Ponder on your time", &ponder)) {
+                            chess->setPonderEnabled(ponder);
+                        }
+
+                        if (chess->isThinking()) {
+                            SearchProgress progress = chess->searchProgress();
+                            if (chess->isPondering()) {
+                                ImGui::Text("Pondering on %s... depth %d, %llu nodes", moveToString(chess->ponderMove()).c_str(),
+                                            progress.depth, static_cast<unsigned long long>(progress.nodes));
+                            } else {
+                                ImGui::Text("Thinking... depth %d, %llu nodes", progress.depth,
+                                            static_cast<unsigned long long>(progress.nodes));
+                            }
+                            for (const SearchLine& line : progress.lines) {
+                                ImGui::TextUnformatted(Chess::describeLine(line).c_str());
+                            }
+                        } else {
+                            for (const SearchLine& line : chess->lastLines()) {
+                                ImGui::TextUnformatted(Chess::describeLine(line).c_str());
+                            }
+                        }
+
+                        // Resizing the pool cancels a running search, so the
+                        // count is only applied once the slider is let go
+                        static int threads = 1;
+                        static bool editingThreads = false;
+                        if (!editingThreads) {
+                            threads = chess->threadCount();
+                        }
+                        int maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+                        ImGui::SliderInt("Threads", &threads, 1, maxThreads);
+                        editingThreads = ImGui::IsItemActive();
+                        if (ImGui::IsItemDeactivatedAfterEdit()) {
+                            chess->setThreadCount(threads);
+                        }
+
+                        if (ImGui::TreeNode("Search pruning")) {
+                            SearchPruning pruning = chess->searchPruning();
+                            bool changed = ImGui::Checkbox("Null move", &pruning.nullMove);
+                            changed |= ImGui::Checkbox("Late move reductions", &pruning.lateMoveReductions);
+                            changed |= ImGui::Checkbox("Reverse futility", &pruning.reverseFutility);
+                            changed |= ImGui::Checkbox("Futility", &pruning.futility);
+                            changed |= ImGui::Checkbox("Late move pruning", &pruning.lateMovePruning);
+                            if (changed) {
+                                chess->setSearchPruning(pruning);
+                            }
+                            ImGui::TreePop();
+                        }
+
+                        static bool evalLoadFailed = false;
+                        if (ImGui::Button("Reload eval weights")) {
+                            evalLoadFailed = !chess->reloadEvalParams();
+                        }
+                        if (evalLoadFailed) {
+                            ImGui::SameLine();
+                            ImGui::Text("resources/eval.txt missing or malformed");
+                        }
+
+                        if (chess->networkLoaded()) {
+                            bool useNetwork = chess->networkEnabled();
+                            if (ImGui::Checkbox("Neural network eval", &useNetwork)) {
+                                chess->setNetworkEnabled(useNetwork);
+                            }
+                        }
+
+                        if (chess->bookLoaded()) {
+                            bool useBook = chess->bookEnabled();
+                            if (ImGui::Checkbox("Opening book", &useBook)) {
+                                chess->setBookEnabled(useBook);
+                            }
+                        }
                     }
                 }
                 ImGui::End();
@@ -3,6 +3,7 @@
 #ifdef _MSC_VER
 #include <intrin.h>
 #endif
+#include <cstdint>
 #include <iostream>
 
 enum ChessPiece
@@ -80,19 +81,48 @@ private:
 
 };
 
+// Kind of move, kept in the top four bits of a BitMove. Bit 2 marks a
+// capture and bit 3 a promotion; the low two bits of a promotion pick the
+// piece, knight through queen.
+enum MoveFlag
+{
+    QuietMove = 0,
+    DoublePawnPush = 1,
+    KingCastle = 2,
+    QueenCastle = 3,
+    CaptureMove = 4,
+    EnPassantCapture = 5,
+    KnightPromotion = 8,
+    BishopPromotion = 9,
+    RookPromotion = 10,
+    QueenPromotion = 11,
+    KnightPromotionCapture = 12,
+    BishopPromotionCapture = 13,
+    RookPromotionCapture = 14,
+    QueenPromotionCapture = 15
+};
+
+// A move packed into 16 bits: from square in bits 0-5, to square in bits
+// 6-11 and a MoveFlag in bits 12-15. Zero (a1a1) is never a legal move, so
+// it doubles as "no move".
 struct BitMove {
-    uint8_t from;
-    uint8_t to;
-    uint8_t piece;
-    
-    BitMove(int from, int to, ChessPiece piece)
-        : from(from), to(to), piece(piece) { }
-        
-    BitMove() : from(0), to(0), piece(NoPiece) { }
-    
-    bool operator==(const BitMove& other) const {
-        return from == other.from && 
-               to == other.to && 
-               piece == other.piece;
-    }
-};
\ No newline at end of file
+    uint16_t data;
+
+    BitMove() : data(0) { }
+    BitMove(int from, int to, int flags = QuietMove)
+        : data(static_cast<uint16_t>(from | (to << 6) | (flags << 12))) { }
+
+    int from() const { return data & 63; }
+    int to() const { return (data >> 6) & 63; }
+    int flags() const { return data >> 12; }
+
+    bool isNull() const { return data == 0; }
+    bool isCapture() const { return (flags() & CaptureMove) != 0; }
+    bool isPromotion() const { return (flags() & KnightPromotion) != 0; }
+    bool isEnPassant() const { return flags() == EnPassantCapture; }
+    bool isCastle() const { return flags() == KingCastle || flags() == QueenCastle; }
+    ChessPiece promotionPiece() const { return static_cast<ChessPiece>(Knight + (flags() & 3)); }
+
+    bool operator==(const BitMove& other) const { return data == other.data; }
+    bool operator!=(const BitMove& other) const { return data != other.data; }
+};
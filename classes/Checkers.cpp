@@ -1,11 +1,10 @@
 #include "Checkers.h"
+#include "CheckersRules.h"
 
 Checkers::Checkers() : Game() {
     _grid = new Grid(8, 8);
     _mustContinueJumping = false;
     _jumpingPiece = nullptr;
-    _redPieces = 12;
-    _yellowPieces = 12;
 }
 
 Checkers::~Checkers() {
@@ -60,102 +59,49 @@ bool Checkers::canBitMoveFrom(Bit &bit, BitHolder &src) {
     if (!src.bit() || bit.getOwner() != getCurrentPlayer()) return false;
     if (_mustContinueJumping && &src != _jumpingPiece) return false;
 
-    ChessSquare* square = static_cast<ChessSquare*>(&src);
-    int x = square->getColumn();
-    int y = square->getRow();
-
     // Must jump if available
-    if (hasJumpAvailable(bit.getOwner())) {
-        return canJumpFrom(*square);
+    int from = squareIndex(src);
+    for (const CheckersMove& move : legalMoves()) {
+        if (move.from == from) return true;
     }
-    return true;
+    return false;
 }
 
 bool Checkers::canBitMoveFromTo(Bit& bit, BitHolder& src, BitHolder& dst) {
     if (!src.bit() || dst.bit()) return false;
-
-    ChessSquare* srcSquare = static_cast<ChessSquare*>(&src);
-    ChessSquare* dstSquare = static_cast<ChessSquare*>(&dst);
-
-    int srcX = srcSquare->getColumn();
-    int srcY = srcSquare->getRow();
-
-    if (!_grid->isEnabled(dstSquare->getColumn(), dstSquare->getRow())) return false;
-
-    bool isKing = (bit.gameTag() == RED_KING || bit.gameTag() == YELLOW_KING);
-    bool isRed = (bit.getOwner() == getPlayerAt(RED_PLAYER));
-
-    // Simple moves (if no jumps required)
-    if (!_mustContinueJumping && !hasJumpAvailable(bit.getOwner())) {
-        if (isKing) {
-            return dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY) ||
-                   dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY);
-        }
-        return isRed ? (dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY)) :
-                       (dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY));
-    }
-
-    // Jump moves
     if (_mustContinueJumping && &src != _jumpingPiece) return false;
 
-    // Check all jump directions
-    auto checkJump = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        if (!middle || !target || !middle->bit()) return false;
-        if (middle->bit()->getOwner() == bit.getOwner()) return false;
-        return dstSquare == target;
-    };
-
-    if (isKing || !isRed) {
-        if (checkJump(_grid->getFL(srcX, srcY), _grid->getFLFL(srcX, srcY))) return true;
-        if (checkJump(_grid->getFR(srcX, srcY), _grid->getFRFR(srcX, srcY))) return true;
+    int from = squareIndex(src);
+    int to = squareIndex(dst);
+    for (const CheckersMove& move : legalMoves()) {
+        if (move.from == from && move.to == to) return true;
     }
-    if (isKing || isRed) {
-        if (checkJump(_grid->getBL(srcX, srcY), _grid->getBLBL(srcX, srcY))) return true;
-        if (checkJump(_grid->getBR(srcX, srcY), _grid->getBRBR(srcX, srcY))) return true;
-    }
-
     return false;
 }
 
 void Checkers::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
-    ChessSquare* srcSquare = static_cast<ChessSquare*>(&src);
-    ChessSquare* dstSquare = static_cast<ChessSquare*>(&dst);
-
-    int srcX = srcSquare->getColumn();
-    int srcY = srcSquare->getRow();
-    int dstX = dstSquare->getColumn();
-    int dstY = dstSquare->getRow();
-
-    // Check for jump
-    ChessSquare* jumped = nullptr;
-    if (dstSquare == _grid->getFLFL(srcX, srcY)) jumped = _grid->getFL(srcX, srcY);
-    else if (dstSquare == _grid->getFRFR(srcX, srcY)) jumped = _grid->getFR(srcX, srcY);
-    else if (dstSquare == _grid->getBLBL(srcX, srcY)) jumped = _grid->getBL(srcX, srcY);
-    else if (dstSquare == _grid->getBRBR(srcX, srcY)) jumped = _grid->getBR(srcX, srcY);
-
-    if (jumped && jumped->bit()) {
-        // Capture
-        (jumped->bit()->getOwner() == getPlayerAt(RED_PLAYER)) ? _redPieces-- : _yellowPieces--;
-        jumped->destroyBit();
+    int srcX = static_cast<ChessSquare&>(src).getColumn();
+    int srcY = static_cast<ChessSquare&>(src).getRow();
+    int dstX = static_cast<ChessSquare&>(dst).getColumn();
+    int dstY = static_cast<ChessSquare&>(dst).getRow();
+
+    // Capture
+    bool jumped = srcX - dstX == 2 || dstX - srcX == 2;
+    if (jumped) {
+        _grid->getSquare((srcX + dstX) / 2, (srcY + dstY) / 2)->destroyBit();
+    }
 
-        // Promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
+    // Promotion check
+    if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
+        bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
+        bit.setScale(1.3f);
+    }
 
-        // Check for more jumps
-        if (canJumpFrom(*dstSquare)) {
-            _mustContinueJumping = true;
-            _jumpingPiece = &dst;
-            return;
-        }
-    } else {
-        // Regular move - promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
+    // Check for more jumps
+    if (jumped && !checkersLegalMoves(stateString(), bit.getOwner()->playerNumber(), squareIndex(dst)).empty()) {
+        _mustContinueJumping = true;
+        _jumpingPiece = &dst;
+        return;
     }
 
     _mustContinueJumping = false;
@@ -163,86 +109,19 @@ void Checkers::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
     endTurn();
 }
 
-bool Checkers::canJumpFrom(ChessSquare& square) const {
-    Bit* piece = square.bit();
-    if (!piece) return false;
-
-    int x = square.getColumn();
-    int y = square.getRow();
-    bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-    bool isRed = (piece->getOwner() == getPlayerAt(RED_PLAYER));
-    Player* player = piece->getOwner();
-
-    auto checkJumpDir = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        return middle && middle->bit() && middle->bit()->getOwner() != player &&
-               target && !target->bit();
-    };
-
-    if (isKing || !isRed) {
-        if (checkJumpDir(_grid->getFL(x, y), _grid->getFLFL(x, y))) return true;
-        if (checkJumpDir(_grid->getFR(x, y), _grid->getFRFR(x, y))) return true;
-    }
-    if (isKing || isRed) {
-        if (checkJumpDir(_grid->getBL(x, y), _grid->getBLBL(x, y))) return true;
-        if (checkJumpDir(_grid->getBR(x, y), _grid->getBRBR(x, y))) return true;
-    }
-    return false;
+std::vector<CheckersMove> Checkers::legalMoves() {
+    int jumpingFrom = _mustContinueJumping ? squareIndex(*_jumpingPiece) : -1;
+    return checkersLegalMoves(stateString(), getCurrentPlayer()->playerNumber(), jumpingFrom);
 }
 
-bool Checkers::hasJumpAvailable(Player* player) const {
-    bool hasJump = false;
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (hasJump) return;
-        Bit* piece = square->bit();
-        if (piece && piece->getOwner() == player) {
-            Checkers* self = const_cast<Checkers*>(this);
-            if (self->canJumpFrom(*square)) {
-                hasJump = true;
-            }
-        }
-    });
-    return hasJump;
+int Checkers::squareIndex(BitHolder& holder) const {
+    ChessSquare& square = static_cast<ChessSquare&>(holder);
+    return square.getRow() * 8 + square.getColumn();
 }
 
 Player* Checkers::checkForWinner() {
-    if (_redPieces == 0) return getPlayerAt(YELLOW_PLAYER);
-    if (_yellowPieces == 0) return getPlayerAt(RED_PLAYER);
-
-    // Check if current player has any moves
-    Player* current = getCurrentPlayer();
-    bool hasMove = false;
-
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (hasMove) return;
-        Bit* piece = square->bit();
-        if (piece && piece->getOwner() == current) {
-            bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-            bool isRed = (current == getPlayerAt(RED_PLAYER));
-
-            // Check for any valid move
-            auto checkMove = [&](ChessSquare* target) {
-                if (target && !target->bit()) hasMove = true;
-            };
-
-            if (isKing) {
-                checkMove(_grid->getFL(x, y));
-                checkMove(_grid->getFR(x, y));
-                checkMove(_grid->getBL(x, y));
-                checkMove(_grid->getBR(x, y));
-            } else if (isRed) {
-                checkMove(_grid->getBL(x, y));
-                checkMove(_grid->getBR(x, y));
-            } else {
-                checkMove(_grid->getFL(x, y));
-                checkMove(_grid->getFR(x, y));
-            }
-        }
-    });
-
-    if (!hasMove) {
-        return current == getPlayerAt(RED_PLAYER) ? getPlayerAt(YELLOW_PLAYER) : getPlayerAt(RED_PLAYER);
-    }
-    return nullptr;
+    int winner = checkersWinner(stateString(), getCurrentPlayer()->playerNumber());
+    return winner >= 0 ? getPlayerAt(winner) : nullptr;
 }
 
 bool Checkers::checkForDraw() {
@@ -255,8 +134,6 @@ void Checkers::stopGame() {
     });
     _mustContinueJumping = false;
     _jumpingPiece = nullptr;
-    _redPieces = 12;
-    _yellowPieces = 12;
 }
 
 std::string Checkers::initialStateString() {
@@ -270,9 +147,6 @@ std::string Checkers::stateString() {
 void Checkers::setStateString(const std::string &s) {
     if (s.length() != 32) return;
 
-    _redPieces = 0;
-    _yellowPieces = 0;
-
     _grid->setStateString(s);
 
     // Recreate pieces from state
@@ -284,7 +158,6 @@ void Checkers::setStateString(const std::string &s) {
                 Bit* piece = createPiece(pieceType);
                 piece->setPosition(square->getPosition());
                 square->setBit(piece);
-                (pieceType == RED_PIECE || pieceType == RED_KING) ? _redPieces++ : _yellowPieces++;
             }
         }
     });
@@ -1,5 +1,7 @@
 #pragma once
 #include "Game.h"
+#include "CheckersRules.h"
+#include <vector>
 
 // NOTE: If Square class needs modifications to support colored squares for checkerboard pattern,
 // add a method like setColor(ImVec4 color) to Square class
@@ -44,14 +46,9 @@ private:
     Bit*        createPiece(int pieceType);
     int         getPieceType(const Bit& bit) const;
     bool        isKing(const Bit& bit) const;
-    bool        isValidMove(int srcX, int srcY, int dstX, int dstY, Player* player) const;
-    bool        isJumpMove(int srcX, int srcY, int dstX, int dstY) const;
-    bool        hasJumpAvailable(Player* player) const;
-    bool        canJumpFrom(ChessSquare& square) const;
-    void        performJump(int srcX, int srcY, int dstX, int dstY);
-    void        promoteToKing(Bit& bit, int y);
-    void        getBoardPosition(BitHolder &holder, int &x, int &y) const;
-    bool        isValidSquare(int x, int y) const;
+    // legal moves for the current player, restricted to the jumping piece mid multi-jump
+    std::vector<CheckersMove> legalMoves();
+    int         squareIndex(BitHolder& holder) const;
 
     // Board representation
     Grid*        _grid;
@@ -59,6 +56,4 @@ private:
     // Game state
     bool        _mustContinueJumping;
     BitHolder*  _jumpingPiece;
-    int         _redPieces;
-    int         _yellowPieces;
 };
\ No newline at end of file
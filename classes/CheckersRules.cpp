@@ -0,0 +1,95 @@
+#include "CheckersRules.h"
+
+namespace {
+    const int RED_PIECE = 1;
+    const int RED_KING = 2;
+    const int YELLOW_PIECE = 3;
+    const int YELLOW_KING = 4;
+
+    bool onBoard(int x, int y) { return x >= 0 && x < 8 && y >= 0 && y < 8; }
+
+    // index into the state string for a dark square
+    int stateIndex(int square) { return square / 2; }
+
+    int ownerOf(int piece) { return piece == 0 ? -1 : (piece <= RED_KING ? 0 : 1); }
+    bool isKing(int piece) { return piece == RED_KING || piece == YELLOW_KING; }
+
+    void addMovesFrom(const std::string& state, int square, bool capturesOnly,
+                      std::vector<CheckersMove>& captures, std::vector<CheckersMove>& simple)
+    {
+        const int piece = checkersPieceAt(state, square);
+        const int player = ownerOf(piece);
+        const int x = square % 8;
+        const int y = square / 8;
+        for (int dy : { -1, 1 }) {
+            // men only move forward: red down the board, yellow up it
+            if (!isKing(piece) && dy != (player == 0 ? 1 : -1)) {
+                continue;
+            }
+            for (int dx : { -1, 1 }) {
+                if (!onBoard(x + dx, y + dy)) {
+                    continue;
+                }
+                const int next = (y + dy) * 8 + x + dx;
+                const int nextPiece = checkersPieceAt(state, next);
+                if (nextPiece == 0) {
+                    if (!capturesOnly) {
+                        simple.push_back({ square, next, -1 });
+                    }
+                } else if (ownerOf(nextPiece) != player && onBoard(x + 2 * dx, y + 2 * dy)) {
+                    const int landing = (y + 2 * dy) * 8 + x + 2 * dx;
+                    if (checkersPieceAt(state, landing) == 0) {
+                        captures.push_back({ square, landing, next });
+                    }
+                }
+            }
+        }
+    }
+}
+
+int checkersPieceAt(const std::string& state, int square)
+{
+    if ((square % 8 + square / 8) % 2 == 0) {
+        return 0;
+    }
+    const int piece = state[stateIndex(square)] - '0';
+    return piece >= RED_PIECE && piece <= YELLOW_KING ? piece : 0;
+}
+
+std::vector<CheckersMove> checkersLegalMoves(const std::string& state, int playerNumber, int jumpingFrom)
+{
+    std::vector<CheckersMove> captures;
+    std::vector<CheckersMove> simple;
+    if (jumpingFrom >= 0) {
+        addMovesFrom(state, jumpingFrom, true, captures, simple);
+        return captures;
+    }
+    for (int square = 0; square < 64; ++square) {
+        if (ownerOf(checkersPieceAt(state, square)) == playerNumber) {
+            addMovesFrom(state, square, false, captures, simple);
+        }
+    }
+    return captures.empty() ? simple : captures;
+}
+
+std::string checkersPlay(const std::string& state, const CheckersMove& move)
+{
+    std::string next = state;
+    int piece = checkersPieceAt(state, move.from);
+    if (piece == RED_PIECE && move.to / 8 == 7) {
+        piece = RED_KING;
+    } else if (piece == YELLOW_PIECE && move.to / 8 == 0) {
+        piece = YELLOW_KING;
+    }
+    next[stateIndex(move.from)] = '0';
+    next[stateIndex(move.to)] = static_cast<char>('0' + piece);
+    if (move.captured >= 0) {
+        next[stateIndex(move.captured)] = '0';
+    }
+    return next;
+}
+
+int checkersWinner(const std::string& state, int playerToMove)
+{
+    return checkersLegalMoves(state, playerToMove).empty() ? 1 - playerToMove : -1;
+}
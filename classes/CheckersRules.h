@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//
+// Checkers rules on the 32 character state string used by
+// Checkers::stateString(): one character per dark square ((x + y) odd),
+// row by row. '0' is empty, '1' a red piece, '2' a red king, '3' a yellow
+// piece and '4' a yellow king. Red is player 0, starts on rows 0-2 and
+// moves toward row 7; yellow is player 1 and moves toward row 0.
+//
+
+// board squares are y * 8 + x
+struct CheckersMove
+{
+    int from;
+    int to;
+    int captured;   // jumped square, or -1 for a simple move
+};
+
+// piece code on the board square, 0 for empty or light squares
+int checkersPieceAt(const std::string& state, int square);
+// Legal moves for the player; captures are forced. A multi-jump in progress
+// passes the jumping piece's square and only gets its further captures.
+std::vector<CheckersMove> checkersLegalMoves(const std::string& state, int playerNumber, int jumpingFrom = -1);
+// state after the move, crowning a piece that reaches the far row
+std::string checkersPlay(const std::string& state, const CheckersMove& move);
+// the opponent when the player to move has no pieces or no moves, else -1
+int checkersWinner(const std::string& state, int playerToMove);
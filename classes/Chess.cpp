@@ -1,6 +1,8 @@
 #include "Chess.h"
-#include "BitBoard.h"
+#include "MoveGen.h"
 #include "MagicBitboards.h"
+#include "Evaluate.h"
+#include "Tablebase.h"
 #include <limits>
 #include <cmath>
 #include <sstream>
@@ -14,26 +16,36 @@
 
 
 namespace {
-    constexpr int posInfinite = 1000000;
-    constexpr int negInfinite = -posInfinite;
-    constexpr int WhiteColor = 1;
-    constexpr int BlackColor = -1;
-    constexpr int defaultSearchDepth = 3;
+    constexpr int defaultMoveTime = 1000;
+    const char* evalParamsPath = "resources/eval.txt";
+    const char* networkPath = "resources/network.nnue";
+    const char* bookPath = "resources/book.bin";
+    // written by the tbgen tool
+    const char* tablebasePath = "resources/tablebases";
+    const char* startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 }
 
 Chess::Chess()
+    : _searchPool(_transpositionTable), _bookRandom(std::random_device()()), _bookEnabled(true),
+      _thinking(false), _ponderEnabled(false), _pondering(false)
 {
     _grid = new Grid(8, 8);
-    _countMoves = 0;
+    _searchLimits.movetime = defaultMoveTime;
     _preferredAIColor = 1; // default AI plays black unless user selects otherwise
     initMagicBitboards();
-    generateKnightMoveBitboards();
-    generateKingMoveBitboards();
-    initializeBitboards();
+    // the built-in weights stay in place if the file is missing
+    loadEvalParams(evalParamsPath);
+    // no network ships with the repo; drop one in to try it
+    nnue.load(networkPath);
+    // nor a book
+    _book.open(bookPath);
+    tablebases.open(tablebasePath);
 }
 
 Chess::~Chess()
 {
+    // the worker reads the attack tables, so it has to finish first
+    cancelSearch();
     cleanupMagicBitboards();
     delete _grid;
 }
@@ -72,8 +84,10 @@ void Chess::setUpBoard()
     _gameOptions.rowX = 8;
     _gameOptions.rowY = 8;
 
+    cancelSearch();
     _grid->initializeChessSquares(pieceSize, "boardsquare.png");
-    FENtoBoard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR");
+    FENtoBoard(startFen);
+    _transpositionTable.clear();
 
     startGame();
 }
@@ -89,6 +103,7 @@ void Chess::enableAIForColor(int playerNumber)
         return;
     }
 
+    cancelSearch();
     _preferredAIColor = playerNumber;
     for (Player* player : _players) {
         if (player) {
@@ -104,6 +119,7 @@ void Chess::enableAIForColor(int playerNumber)
 
 void Chess::disableAI()
 {
+    cancelSearch();
     for (Player* player : _players) {
         if (player) {
             player->setAIPlayer(false);
@@ -134,69 +150,125 @@ int Chess::preferredAIColor() const
     return _preferredAIColor;
 }
 
-void Chess::FENtoBoard(const std::string& fen) {
-    _grid->forEachSquare([](ChessSquare* square, int, int) {
-        if (square) square->destroyBit();
-    });
+void Chess::setHashMegabytes(size_t megabytes)
+{
+    if (megabytes != _transpositionTable.megabytes()) {
+        cancelSearch();
+        _transpositionTable.resize(megabytes);
+    }
+}
 
-    std::istringstream iss(fen);
-    std::string placement, activeColor, castling, enpassant, halfmove, fullmove;
-    iss >> placement >> activeColor >> castling >> enpassant >> halfmove >> fullmove;
+size_t Chess::hashMegabytes() const
+{
+    return _transpositionTable.megabytes();
+}
 
-    if (placement.empty())
-        return;
+void Chess::setMoveTime(int milliseconds)
+{
+    _searchLimits.movetime = std::max(1, milliseconds);
+}
+
+int Chess::moveTime() const
+{
+    return _searchLimits.movetime;
+}
 
-    std::vector<std::string> ranks;
-    {
-        std::istringstream rankStream(placement);
-        std::string rank;
-        while (std::getline(rankStream, rank, '/'))
-            ranks.push_back(rank);
+void Chess::setThreadCount(int threads)
+{
+    cancelSearch();
+    _searchPool.setThreadCount(threads);
+}
+
+int Chess::threadCount() const
+{
+    return _searchPool.threadCount();
+}
+
+void Chess::setPonderEnabled(bool enabled)
+{
+    _ponderEnabled = enabled;
+    if (!enabled && _pondering) {
+        cancelSearch();
     }
+}
 
-    if (ranks.size() != 8) {
-        std::cerr << "Invalid FEN: expected 8 ranks, got " << ranks.size() << "\n";
-        return;
+void Chess::setMultiPV(int lines)
+{
+    _searchLimits.multiPV = std::max(1, lines);
+}
+
+int Chess::multiPV() const
+{
+    return _searchLimits.multiPV;
+}
+
+std::string Chess::describeLine(const SearchLine& line)
+{
+    std::ostringstream text;
+    if (line.score >= mateBound) {
+        text << "#" << (mateValue - line.score + 1) / 2;
+    } else if (line.score <= -mateBound) {
+        text << "#-" << (mateValue + line.score) / 2;
+    } else {
+        text << std::showpos << std::fixed << std::setprecision(2) << line.score / 100.0 << std::noshowpos;
     }
+    for (const BitMove& move : line.pv) {
+        text << " " << moveToString(move);
+    }
+    return text.str();
+}
 
-    for (size_t r = 0; r < 8; ++r) {
-        const std::string& rankStr = ranks[r];
-        int y = 7 - static_cast<int>(r);
-        int x = 0;
-
-        for (char c : rankStr) {
-            if (std::isdigit(static_cast<unsigned char>(c))) {
-                x += c - '0';
-                continue;
-            }
-
-            if (x >= 8) break;
-
-            bool isWhite = std::isupper(static_cast<unsigned char>(c));
-            char lower = std::tolower(static_cast<unsigned char>(c));
-
-            ChessPiece piece = NoPiece;
-            switch (lower) {
-                case 'p': piece = Pawn; break;
-                case 'n': piece = Knight; break;
-                case 'b': piece = Bishop; break;
-                case 'r': piece = Rook; break;
-                case 'q': piece = Queen; break;
-                case 'k': piece = King; break;
-                default:  piece = NoPiece; break;
-            }
-
-            if (piece != NoPiece) {
-                Bit* bit = PieceForPlayer(isWhite ? 0 : 1, piece);
-                if (ChessSquare* square = _grid->getSquare(x, y)) {
-                    square->dropBitAtPoint(bit, square->getPosition());
-                }
-            }
-            ++x;
-        }
+void Chess::setSearchPruning(const SearchPruning& pruning)
+{
+    _searchLimits.pruning = pruning;
+}
+
+const SearchPruning& Chess::searchPruning() const
+{
+    return _searchLimits.pruning;
+}
+
+bool Chess::reloadEvalParams()
+{
+    cancelSearch();
+    return loadEvalParams(evalParamsPath);
+}
+
+bool Chess::networkLoaded() const
+{
+    return nnue.isLoaded();
+}
+
+bool Chess::networkEnabled() const
+{
+    return nnue.isEnabled();
+}
+
+void Chess::setNetworkEnabled(bool enabled)
+{
+    // positions only track the accumulator while the network is on
+    cancelSearch();
+    nnue.setEnabled(enabled);
+}
+
+// Load a FEN into the engine position, then lay the grid out to match it
+void Chess::FENtoBoard(const std::string& fen) {
+    _grid->forEachSquare([](ChessSquare* square, int, int) {
+        if (square) square->destroyBit();
+    });
+
+    if (!_position.setFromFen(fen)) {
+        std::cerr << "Invalid FEN: " << fen << "\n";
+        return;
     }
 
-    updateBitboards();
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        int piece = _position.pieceOn(squareToIndex(x, y));
+        if (piece) {
+            Bit* bit = PieceForPlayer(pieceColor(piece) == White ? 0 : 1, pieceType(piece));
+            square->dropBitAtPoint(bit, square->getPosition());
+        }
+    });
 }
 
 bool Chess::actionForEmptyHolder(BitHolder &holder)
@@ -214,9 +286,6 @@ bool Chess::canBitMoveFrom(Bit &bit, BitHolder &src)
     // Clear any previous highlights
     clearBoardHighlights();
     
-    // Update bitboards and generate valid moves
-    updateBitboards();
-    
     ChessSquare* srcSquare = dynamic_cast<ChessSquare*>(&src);
     if (!srcSquare) return true;
     
@@ -224,16 +293,15 @@ bool Chess::canBitMoveFrom(Bit &bit, BitHolder &src)
     int srcY = srcSquare->getRow();
     int srcIndex = squareToIndex(srcX, srcY);
     
-    // Generate all valid moves for this piece
-    std::vector<BitMove> validMoves = generateValidMoves(srcIndex);
-    const std::string state = stateString();
-    const bool isWhitePiece = (bit.gameTag() < 128);
-    std::vector<BitMove> legalMoves = filterLegalMoves(state, validMoves, isWhitePiece);
+    // Generate all legal moves for the side to move
+    MoveList legalMoves;
+    generateLegalMoves(_position, legalMoves);
     
-    // Highlight all valid destination squares
+    // Highlight all valid destination squares for this piece
     for (const auto& move : legalMoves) {
+        if (move.from() != srcIndex) continue;
         int destX, destY;
-        indexToSquare(move.to, destX, destY);
+        indexToSquare(move.to(), destX, destY);
         ChessSquare* destSquare = _grid->getSquare(destX, destY);
         if (destSquare) {
             destSquare->setHighlighted(true);
@@ -249,7 +317,6 @@ bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
     // Clear highlights since we're attempting a move
     clearBoardHighlights();
     
-    updateBitboards();
     ChessSquare* srcSquare = dynamic_cast<ChessSquare*>(&src);
     ChessSquare* dstSquare = dynamic_cast<ChessSquare*>(&dst);
     if (!srcSquare || !dstSquare) return false;
@@ -261,20 +328,91 @@ bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
     int srcIndex = squareToIndex(srcX, srcY);
     int dstIndex = squareToIndex(dstX, dstY);
     
-    std::vector<BitMove> validMoves = generateValidMoves(srcIndex);
-    const std::string state = stateString();
-    const bool isWhitePiece = (bit.gameTag() < 128);
-    std::vector<BitMove> legalMoves = filterLegalMoves(state, validMoves, isWhitePiece);
-    
-    // Check if this is a valid move
+    // Valid move; actual capture/removal happens when the engine finalizes the move
+    return !findLegalMove(srcIndex, dstIndex).isNull();
+}
+
+void Chess::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
+{
+    ChessSquare* srcSquare = dynamic_cast<ChessSquare*>(&src);
+    ChessSquare* dstSquare = dynamic_cast<ChessSquare*>(&dst);
+    if (!srcSquare || !dstSquare) return;
+
+    // a pawn dragged to the last rank always becomes a queen
+    int srcIndex = squareToIndex(srcSquare->getColumn(), srcSquare->getRow());
+    int dstIndex = squareToIndex(dstSquare->getColumn(), dstSquare->getRow());
+    BitMove move = findLegalMove(srcIndex, dstIndex);
+    if (!move.isNull()) {
+        finishMove(move);
+    }
+}
+
+BitMove Chess::findLegalMove(int from, int to) const
+{
+    // promotions are generated queen first
+    MoveList legalMoves;
+    generateLegalMoves(_position, legalMoves);
     for (const BitMove& move : legalMoves) {
-        if (move.to == dstIndex) {
-            // Valid move; actual capture/removal happens when the engine finalizes the move
-            return true;
+        if (move.from() == from && move.to() == to) {
+            return move;
         }
     }
-    
-    return false;
+    return BitMove();
+}
+
+void Chess::moveBit(int from, int to)
+{
+    int srcX, srcY, dstX, dstY;
+    indexToSquare(from, srcX, srcY);
+    indexToSquare(to, dstX, dstY);
+    ChessSquare* srcSquare = _grid->getSquare(srcX, srcY);
+    ChessSquare* dstSquare = _grid->getSquare(dstX, dstY);
+    if (!srcSquare || !dstSquare || !srcSquare->bit()) {
+        return;
+    }
+
+    Bit* bit = srcSquare->bit();
+    dstSquare->destroyBit();
+    dstSquare->dropBitAtPoint(bit, dstSquare->getPosition());
+    srcSquare->setBit(nullptr);
+}
+
+void Chess::finishMove(const BitMove& move)
+{
+    // the human's reply settles a running ponder search one way or the other
+    if (_pondering) {
+        if (move == _ponderMove) {
+            _searchPool.ponderHit();
+            _pondering = false;
+        } else {
+            cancelSearch();
+        }
+    }
+
+    const int playerNumber = (_position.sideToMove() == White) ? 0 : 1;
+    const int to = move.to();
+    int x, y;
+
+    if (move.isCastle()) {
+        if (move.flags() == KingCastle) {
+            moveBit(to + 1, to - 1);
+        } else {
+            moveBit(to - 2, to + 1);
+        }
+    } else if (move.isEnPassant()) {
+        indexToSquare(playerNumber == 0 ? to - 8 : to + 8, x, y);
+        _grid->getSquare(x, y)->destroyBit();
+    }
+
+    if (move.isPromotion()) {
+        indexToSquare(to, x, y);
+        ChessSquare* square = _grid->getSquare(x, y);
+        square->destroyBit();
+        square->dropBitAtPoint(PieceForPlayer(playerNumber, move.promotionPiece()), square->getPosition());
+    }
+
+    _position.makeMove(move);
+    endTurn();
 }
 
 void Chess::clearBoardHighlights()
@@ -289,6 +427,7 @@ void Chess::clearBoardHighlights()
 
 void Chess::stopGame()
 {
+    cancelSearch();
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
     });
@@ -309,10 +448,10 @@ Player* Chess::ownerAt(int x, int y) const
 
 Player* Chess::checkForWinner()
 {
-    const std::string state = stateString();
-    const bool whiteTurn = (getCurrentPlayer()->playerNumber() == 0);
-    const bool inCheck = isKingInCheck(state, whiteTurn);
-    const std::vector<BitMove> legalMoves = generateAllLegalMovesFromState(state, whiteTurn);
+    const bool whiteTurn = (_position.sideToMove() == White);
+    const bool inCheck = _position.inCheck();
+    MoveList legalMoves;
+    generateLegalMoves(_position, legalMoves);
 
     if (inCheck && legalMoves.empty()) {
         const int winnerIndex = whiteTurn ? 1 : 0;
@@ -324,10 +463,15 @@ Player* Chess::checkForWinner()
 
 bool Chess::checkForDraw()
 {
-    const std::string state = stateString();
-    const bool whiteTurn = (getCurrentPlayer()->playerNumber() == 0);
-    const bool inCheck = isKingInCheck(state, whiteTurn);
-    const std::vector<BitMove> legalMoves = generateAllLegalMovesFromState(state, whiteTurn);
+    // every move of the game is on the position's key history, so the
+    // third occurrence and the hundredth quiet ply are seen from here
+    if (_position.isDraw(0)) {
+        return true;
+    }
+
+    const bool inCheck = _position.inCheck();
+    MoveList legalMoves;
+    generateLegalMoves(_position, legalMoves);
 
     return !inCheck && legalMoves.empty();
 }
@@ -360,715 +504,83 @@ void Chess::setStateString(const std::string &s)
     });
 }
 
-void Chess::initializeBitboards()
-{
-    _whitePawns.setData(0ULL);
-    _whiteKnights.setData(0ULL);
-    _whiteBishops.setData(0ULL);
-    _whiteRooks.setData(0ULL);
-    _whiteQueens.setData(0ULL);
-    _whiteKing.setData(0ULL);
-    _blackPawns.setData(0ULL);
-    _blackKnights.setData(0ULL);
-    _blackBishops.setData(0ULL);
-    _blackRooks.setData(0ULL);
-    _blackQueens.setData(0ULL);
-    _blackKing.setData(0ULL);
-    _allWhitePieces.setData(0ULL);
-    _allBlackPieces.setData(0ULL);
-    _allPieces.setData(0ULL);
-}
-
-void Chess::updateBitboards()
-{
-    initializeBitboards();
-    
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit* bit = square->bit();
-        if (!bit) return;
-        
-        int index = squareToIndex(x, y);
-        uint64_t mask = 1ULL << index;
-        
-        bool isWhite = (bit->gameTag() < 128);
-        ChessPiece piece = static_cast<ChessPiece>(bit->gameTag() % 128);
-        
-        if (isWhite) {
-            _allWhitePieces |= mask;
-            switch (piece) {
-                case Pawn: _whitePawns |= mask; break;
-                case Knight: _whiteKnights |= mask; break;
-                case Bishop: _whiteBishops |= mask; break;
-                case Rook: _whiteRooks |= mask; break;
-                case Queen: _whiteQueens |= mask; break;
-                case King: _whiteKing |= mask; break;
-                default: break;
-            }
-        } else {
-            _allBlackPieces |= mask;
-            switch (piece) {
-                case Pawn: _blackPawns |= mask; break;
-                case Knight: _blackKnights |= mask; break;
-                case Bishop: _blackBishops |= mask; break;
-                case Rook: _blackRooks |= mask; break;
-                case Queen: _blackQueens |= mask; break;
-                case King: _blackKing |= mask; break;
-                default: break;
-            }
-        }
-    });
-    
-    _allPieces.setData(_allWhitePieces.getData() | _allBlackPieces.getData());
-}
-
-void Chess::generateKnightMoveBitboards()
-{
-    for (int square = 0; square < 64; ++square) {
-        _knightMoves[square] = generateKnightMoves(square);
-    }
-}
-
-void Chess::generateKingMoveBitboards()
+void Chess::cancelSearch()
 {
-    for (int square = 0; square < 64; ++square) {
-        _kingMoves[square] = generateKingMoves(square);
+    if (_thinking) {
+        _searchPool.stop();
+        _searchPool.wait();
+        _thinking = false;
     }
+    _pondering = false;
 }
 
-BitboardElement Chess::generateKnightMoves(int square) const
+void Chess::startPondering(const SearchResult& result)
 {
-    uint64_t moves = 0ULL;
-    int rank = square / 8;
-    int file = square % 8;
-    
-    int knightOffsets[8][2] = {
-        {2, 1}, {2, -1}, {-2, 1}, {-2, -1},
-        {1, 2}, {1, -2}, {-1, 2}, {-1, -2}
-    };
-    
-    for (int i = 0; i < 8; ++i) {
-        int newFile = file + knightOffsets[i][0];
-        int newRank = rank + knightOffsets[i][1];
-        
-        if (newFile >= 0 && newFile < 8 && newRank >= 0 && newRank < 8) {
-            int targetSquare = newRank * 8 + newFile;
-            moves |= (1ULL << targetSquare);
-        }
-    }
-    
-    return BitboardElement(moves);
-}
-
-BitboardElement Chess::generateKingMoves(int square) const
-{
-    uint64_t moves = 0ULL;
-    int rank = square / 8;
-    int file = square % 8;
-    
-    int kingOffsets[8][2] = {
-        {0, 1}, {0, -1}, {1, 0}, {-1, 0},
-        {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
-    };
-    
-    for (int i = 0; i < 8; ++i) {
-        int newFile = file + kingOffsets[i][0];
-        int newRank = rank + kingOffsets[i][1];
-        
-        if (newFile >= 0 && newFile < 8 && newRank >= 0 && newRank < 8) {
-            int targetSquare = newRank * 8 + newFile;
-            moves |= (1ULL << targetSquare);
-        }
-    }
-    
-    return BitboardElement(moves);
-}
-
-std::vector<BitMove> Chess::generatePawnMoves(int square, bool isWhite) const
-{
-    std::vector<BitMove> moves;
-    int rank = square / 8;
-    int file = square % 8;
-    
-    int direction = isWhite ? 1 : -1;
-    int startRank = isWhite ? 1 : 6;
-    
-    int targetRank = rank + direction;
-    if (targetRank >= 0 && targetRank < 8) {
-        int targetSquare = targetRank * 8 + file;
-        uint64_t targetMask = 1ULL << targetSquare;
-        
-        if ((_allPieces.getData() & targetMask) == 0) {
-            moves.emplace_back(square, targetSquare, Pawn);
-            
-            if (rank == startRank) {
-                int doublePushRank = rank + 2 * direction;
-                int doublePushSquare = doublePushRank * 8 + file;
-                uint64_t doublePushMask = 1ULL << doublePushSquare;
-                
-                if ((_allPieces.getData() & doublePushMask) == 0) {
-                    moves.emplace_back(square, doublePushSquare, Pawn);
-                }
-            }
-        }
-    }
-    
-    for (int captureFile : {file - 1, file + 1}) {
-        if (captureFile >= 0 && captureFile < 8) {
-            int captureRank = rank + direction;
-            if (captureRank >= 0 && captureRank < 8) {
-                int captureSquare = captureRank * 8 + captureFile;
-                uint64_t captureMask = 1ULL << captureSquare;
-                
-                uint64_t opponentPieces = isWhite ? _allBlackPieces.getData() : _allWhitePieces.getData();
-                if (opponentPieces & captureMask) {
-                    moves.emplace_back(square, captureSquare, Pawn);
-                }
-            }
-        }
+    if (!_ponderEnabled || _gameOptions.AIvsAI || getCurrentPlayer()->isAIPlayer()
+        || result.lines.empty() || result.lines[0].pv.size() < 2) {
+        return;
     }
-    
-    return moves;
-}
 
-std::vector<BitMove> Chess::generateValidMoves(int square) const
-{
-    std::vector<BitMove> moves;
-    
-    int x, y;
-    indexToSquare(square, x, y);
-    ChessSquare* sq = _grid->getSquare(x, y);
-    if (!sq || !sq->bit()) return moves;
-    
-    Bit* bit = sq->bit();
-    bool isWhite = (bit->gameTag() < 128);
-    ChessPiece piece = static_cast<ChessPiece>(bit->gameTag() % 128);
-    
-    uint64_t friendlyPieces = isWhite ? _allWhitePieces.getData() : _allBlackPieces.getData();
-    uint64_t opponentPieces = isWhite ? _allBlackPieces.getData() : _allWhitePieces.getData();
-    
-    switch (piece) {
-        case Knight: {
-            BitboardElement validMoves(_knightMoves[square].getData() & ~friendlyPieces);
-            validMoves.forEachBit([&](int targetSquare) {
-                moves.emplace_back(square, targetSquare, Knight);
-            });
-            break;
-        }
-        
-        case King: {
-            BitboardElement validMoves(_kingMoves[square].getData() & ~friendlyPieces);
-            validMoves.forEachBit([&](int targetSquare) {
-                moves.emplace_back(square, targetSquare, King);
-            });
-            break;
-        }
-        
-        case Pawn: {
-            moves = generatePawnMoves(square, isWhite);
-            break;
-        }
-        
-        case Rook: {
-            uint64_t rookMoves = getRookAttacks(square, _allPieces.getData()) & ~friendlyPieces;
-            BitboardElement validMoves(rookMoves);
-            validMoves.forEachBit([&](int targetSquare) {
-                moves.emplace_back(square, targetSquare, Rook);
-            });
-            break;
-        }
-        
-        case Bishop: {
-            uint64_t bishopMoves = getBishopAttacks(square, _allPieces.getData()) & ~friendlyPieces;
-            BitboardElement validMoves(bishopMoves);
-            validMoves.forEachBit([&](int targetSquare) {
-                moves.emplace_back(square, targetSquare, Bishop);
-            });
-            break;
-        }
-        
-        case Queen: {
-            uint64_t queenMoves = getQueenAttacks(square, _allPieces.getData()) & ~friendlyPieces;
-            BitboardElement validMoves(queenMoves);
-            validMoves.forEachBit([&](int targetSquare) {
-                moves.emplace_back(square, targetSquare, Queen);
-            });
-            break;
-        }
-        
-        default:
-            break;
-    }
-    
-    return moves;
+    _ponderMove = result.lines[0].pv[1];
+    Position ponderPosition = _position;
+    ponderPosition.makeMove(_ponderMove);
+    SearchLimits limits = _searchLimits;
+    limits.ponder = true;
+    _searchPool.start(ponderPosition, limits);
+    _thinking = true;
+    _pondering = true;
 }
 
+// Called once a frame while it is the AI's turn. The first call starts the
+// search on a worker thread; later calls return straight away until it is
+// done, then play the move on the UI thread.
 void Chess::updateAI()
 {
-    updateBitboards();
-
-    const int playerColor = (getCurrentPlayer()->playerNumber() == 0) ? WhiteColor : BlackColor;
-    std::string state = stateString();
-
-    std::vector<BitMove> moves = generateAllMoves(state, playerColor);
-    if (moves.empty()) {
+    if (!_thinking) {
+        const BitMove bookMove = _bookEnabled ? _book.pickMove(_position, _bookRandom) : BitMove();
+        if (!bookMove.isNull()) {
+            std::cout << "Book move " << moveToString(bookMove) << std::endl;
+            _lastLines.clear();
+            moveBit(bookMove.from(), bookMove.to());
+            finishMove(bookMove);
+            return;
+        }
+        _searchPool.start(_position, _searchLimits);
+        _thinking = true;
         return;
     }
-
-    const auto searchStart = std::chrono::steady_clock::now();
-    _countMoves = 0;
-
-    BitMove bestMove;
-    int bestVal = negInfinite;
-
-    for (const BitMove& move : moves) {
-        char boardSave = state[move.to];
-        char pieceMoving = state[move.from];
-
-        state[move.to] = pieceMoving;
-        state[move.from] = '0';
-
-        int moveVal = -negamax(state, defaultSearchDepth - 1, negInfinite, posInfinite, -playerColor);
-
-        state[move.from] = pieceMoving;
-        state[move.to] = boardSave;
-
-        if (moveVal > bestVal) {
-            bestVal = moveVal;
-            bestMove = move;
-        }
-    }
-
-    if (bestVal == negInfinite) {
-        return;
-    }
-
-    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - searchStart).count();
-    const double nodesPerSecond = seconds > 0.0 ? static_cast<double>(_countMoves) / seconds : 0.0;
-    std::cout << "Negamax depth " << defaultSearchDepth
-              << " score " << bestVal
-              << " nodes " << _countMoves
-              << " (" << std::fixed << std::setprecision(2) << nodesPerSecond
-              << " nodes/s)" << std::defaultfloat << std::endl;
-
-    int srcX = bestMove.from % 8;
-    int srcY = bestMove.from / 8;
-    int dstX = bestMove.to % 8;
-    int dstY = bestMove.to / 8;
-
-    ChessSquare* srcSquare = _grid->getSquare(srcX, srcY);
-    ChessSquare* dstSquare = _grid->getSquare(dstX, dstY);
-    if (!srcSquare || !dstSquare) {
+    if (_searchPool.isSearching()) {
         return;
     }
 
-    Bit* bit = srcSquare->bit();
-    if (!bit) {
+    SearchResult result = _searchPool.wait();
+    _thinking = false;
+    _lastLines = result.lines;
+    if (result.bestMove.isNull()) {
         return;
     }
 
-    if (dstSquare->bit()) {
-        dstSquare->destroyBit();
-    }
-
-    dstSquare->dropBitAtPoint(bit, dstSquare->getPosition());
-    srcSquare->setBit(nullptr);
-    bitMovedFromTo(*bit, *srcSquare, *dstSquare);
-}
-
-std::vector<BitMove> Chess::generateAllLegalMoves(bool forWhite)
-{
-    updateBitboards();
-    std::vector<BitMove> moves;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (!square) return;
-        Bit* bit = square->bit();
-        if (!bit) return;
-        bool isWhitePiece = bit->gameTag() < 128;
-        if (isWhitePiece != forWhite) return;
-        int index = squareToIndex(x, y);
-        auto pieceMoves = generateValidMoves(index);
-        moves.insert(moves.end(), pieceMoves.begin(), pieceMoves.end());
-    });
-    const std::string state = stateString();
-    return filterLegalMoves(state, moves, forWhite);
-}
-
-std::vector<BitMove> Chess::generatePawnMovesFromState(int square,
-                                                       bool isWhite,
-                                                       uint64_t allPieces,
-                                                       uint64_t enemyPieces) const
-{
-    std::vector<BitMove> moves;
-
-    int rank = square / 8;
-    int file = square % 8;
-    int direction = isWhite ? 1 : -1;
-    int startRank = isWhite ? 1 : 6;
-
-    int forwardRank = rank + direction;
-    if (forwardRank >= 0 && forwardRank < 8) {
-        int oneStepSquare = forwardRank * 8 + file;
-        uint64_t oneStepMask = 1ULL << oneStepSquare;
-        if ((allPieces & oneStepMask) == 0) {
-            moves.emplace_back(square, oneStepSquare, Pawn);
-
-            if (rank == startRank) {
-                int doubleRank = rank + 2 * direction;
-                if (doubleRank >= 0 && doubleRank < 8) {
-                    int doubleSquare = doubleRank * 8 + file;
-                    uint64_t doubleMask = 1ULL << doubleSquare;
-                    if ((allPieces & doubleMask) == 0) {
-                        moves.emplace_back(square, doubleSquare, Pawn);
-                    }
-                }
-            }
-        }
-    }
-
-    for (int fileOffset : {-1, 1}) {
-        int captureFile = file + fileOffset;
-        int captureRank = rank + direction;
-        if (captureFile < 0 || captureFile >= 8 || captureRank < 0 || captureRank >= 8) {
-            continue;
-        }
-
-        int captureSquare = captureRank * 8 + captureFile;
-        uint64_t captureMask = 1ULL << captureSquare;
-        if (enemyPieces & captureMask) {
-            moves.emplace_back(square, captureSquare, Pawn);
-        }
-    }
-
-    return moves;
-}
-
-std::vector<BitMove> Chess::generateAllLegalMovesFromState(const std::string& state,
-                                                           bool isWhiteTurn) const
-{
-    std::vector<BitMove> moves;
-    if (state.size() < 64) {
-        return moves;
-    }
-
-    uint64_t whitePieces = 0ULL;
-    uint64_t blackPieces = 0ULL;
-
-    for (int square = 0; square < 64; ++square) {
-        char c = state[square];
-        if (c == '0') {
-            continue;
-        }
-
-        bool isWhitePiece = std::isupper(static_cast<unsigned char>(c));
-        uint64_t mask = 1ULL << square;
-        if (isWhitePiece) {
-            whitePieces |= mask;
-        } else {
-            blackPieces |= mask;
-        }
-    }
-
-    uint64_t allPieces = whitePieces | blackPieces;
-    uint64_t friendlyPieces = isWhiteTurn ? whitePieces : blackPieces;
-    uint64_t enemyPieces = isWhiteTurn ? blackPieces : whitePieces;
-
-    for (int square = 0; square < 64; ++square) {
-        char c = state[square];
-        if (c == '0') {
-            continue;
-        }
-
-        bool isWhitePiece = std::isupper(static_cast<unsigned char>(c));
-        if (isWhitePiece != isWhiteTurn) {
-            continue;
-        }
-
-        ChessPiece piece = NoPiece;
-        switch (std::tolower(static_cast<unsigned char>(c))) {
-            case 'p': piece = Pawn; break;
-            case 'n': piece = Knight; break;
-            case 'b': piece = Bishop; break;
-            case 'r': piece = Rook; break;
-            case 'q': piece = Queen; break;
-            case 'k': piece = King; break;
-            default: break;
-        }
-
-        if (piece == NoPiece) {
-            continue;
-        }
-
-        switch (piece) {
-            case Pawn: {
-                auto pawnMoves = generatePawnMovesFromState(square, isWhiteTurn, allPieces, enemyPieces);
-                moves.insert(moves.end(), pawnMoves.begin(), pawnMoves.end());
-                break;
-            }
-            case Knight: {
-                uint64_t knightMoves = _knightMoves[square].getData() & ~friendlyPieces;
-                BitboardElement validMoves(knightMoves);
-                validMoves.forEachBit([&](int targetSquare) {
-                    moves.emplace_back(square, targetSquare, Knight);
-                });
-                break;
-            }
-            case King: {
-                uint64_t kingMoves = _kingMoves[square].getData() & ~friendlyPieces;
-                BitboardElement validMoves(kingMoves);
-                validMoves.forEachBit([&](int targetSquare) {
-                    moves.emplace_back(square, targetSquare, King);
-                });
-                break;
-            }
-            case Rook: {
-                uint64_t rookMoves = getRookAttacks(square, allPieces) & ~friendlyPieces;
-                BitboardElement validMoves(rookMoves);
-                validMoves.forEachBit([&](int targetSquare) {
-                    moves.emplace_back(square, targetSquare, Rook);
-                });
-                break;
-            }
-            case Bishop: {
-                uint64_t bishopMoves = getBishopAttacks(square, allPieces) & ~friendlyPieces;
-                BitboardElement validMoves(bishopMoves);
-                validMoves.forEachBit([&](int targetSquare) {
-                    moves.emplace_back(square, targetSquare, Bishop);
-                });
-                break;
-            }
-            case Queen: {
-                uint64_t queenMoves = getQueenAttacks(square, allPieces) & ~friendlyPieces;
-                BitboardElement validMoves(queenMoves);
-                validMoves.forEachBit([&](int targetSquare) {
-                    moves.emplace_back(square, targetSquare, Queen);
-                });
-                break;
-            }
-            default:
-                break;
-        }
-    }
-
-    return filterLegalMoves(state, moves, isWhiteTurn);
-}
-
-std::vector<BitMove> Chess::generateAllMoves(const std::string& state, int playerColor) const
-{
-    bool isWhiteTurn = (playerColor == WhiteColor);
-    return generateAllLegalMovesFromState(state, isWhiteTurn);
-}
-
-std::string Chess::applyMoveToState(const std::string& state, const BitMove& move) const
-{
-    if (state.size() < 64) {
-        return state;
-    }
-
-    std::string nextState = state;
-    if (move.from >= nextState.size() || move.to >= nextState.size()) {
-        return nextState;
-    }
-
-    nextState[move.to] = nextState[move.from];
-    nextState[move.from] = '0';
-    return nextState;
-}
-
-int Chess::evaluateBoard(const std::string& state) const
-{
-    static const std::map<char, int> evaluateScores = {
-        {'P', 100},  {'p', -100},
-        {'N', 200},  {'n', -200},
-        {'B', 230},  {'b', -230},
-        {'R', 400},  {'r', -400},
-        {'Q', 900},  {'q', -900},
-        {'K', 2000}, {'k', -2000},
-        {'0', 0}
-    };
-
-    int value = 0;
-    for (char ch : state) {
-        auto it = evaluateScores.find(ch);
-        if (it != evaluateScores.end()) {
-            value += it->second;
-        }
-    }
-    return value;
-}
-
-int Chess::negamax(std::string& state, int depth, int alpha, int beta, int playerColor)
-{
-    _countMoves++;
-
-    if (depth == 0) {
-        return evaluateBoard(state) * playerColor;
-    }
-
-    std::vector<BitMove> newMoves = generateAllMoves(state, playerColor);
-    if (newMoves.empty()) {
-        const bool whiteTurn = (playerColor == WhiteColor);
-        if (isKingInCheck(state, whiteTurn)) {
-            return negInfinite + depth;
-        }
-        return 0;
-    }
-
-    int bestVal = negInfinite;
-
-    for (const BitMove& move : newMoves) {
-        char boardSave = state[move.to];
-        char pieceMoving = state[move.from];
-
-        state[move.to] = pieceMoving;
-        state[move.from] = '0';
-
-        int score = -negamax(state, depth - 1, -beta, -alpha, -playerColor);
-
-        state[move.from] = pieceMoving;
-        state[move.to] = boardSave;
-
-        bestVal = std::max(bestVal, score);
-        alpha = std::max(alpha, bestVal);
-        if (alpha >= beta) {
-            break;
-        }
-    }
-
-    return bestVal;
-}
-
-std::vector<BitMove> Chess::filterLegalMoves(const std::string& state,
-                                             const std::vector<BitMove>& moves,
-                                             bool isWhiteTurn) const
-{
-    std::vector<BitMove> legalMoves;
-    legalMoves.reserve(moves.size());
-
-    for (const BitMove& move : moves) {
-        std::string nextState = applyMoveToState(state, move);
-        if (!isKingInCheck(nextState, isWhiteTurn)) {
-            legalMoves.push_back(move);
-        }
-    }
-
-    return legalMoves;
-}
-
-bool Chess::isKingInCheck(const std::string& state, bool whiteKing) const
-{
-    const char kingChar = whiteKing ? 'K' : 'k';
-    int kingSquare = -1;
-    for (int square = 0; square < static_cast<int>(state.size()); ++square) {
-        if (state[square] == kingChar) {
-            kingSquare = square;
-            break;
-        }
-    }
-
-    if (kingSquare == -1) {
-        // Missing king is an invalid state; treat as check to block the move.
-        return true;
-    }
-
-    return isSquareAttacked(state, kingSquare, !whiteKing);
-}
-
-bool Chess::isSquareAttacked(const std::string& state, int targetSquare, bool byWhite) const
-{
-    if (targetSquare < 0 || targetSquare >= 64) {
-        return false;
-    }
-
-    uint64_t whitePieces = 0ULL;
-    uint64_t blackPieces = 0ULL;
-
-    for (int square = 0; square < 64; ++square) {
-        char c = state[square];
-        if (c == '0') {
-            continue;
-        }
-
-        const bool isWhitePiece = std::isupper(static_cast<unsigned char>(c));
-        uint64_t mask = 1ULL << square;
-        if (isWhitePiece) {
-            whitePieces |= mask;
-        } else {
-            blackPieces |= mask;
-        }
-    }
-
-    const uint64_t allPieces = whitePieces | blackPieces;
-    const uint64_t targetMask = 1ULL << targetSquare;
-
-    for (int square = 0; square < 64; ++square) {
-        char c = state[square];
-        if (c == '0') {
-            continue;
-        }
-
-        const bool isWhitePiece = std::isupper(static_cast<unsigned char>(c));
-        if (isWhitePiece != byWhite) {
-            continue;
-        }
-
-        const char pieceChar = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-        switch (pieceChar) {
-            case 'p': {
-                const int rank = square / 8;
-                const int file = square % 8;
-                const int direction = byWhite ? 1 : -1;
-                const int attackRank = rank + direction;
-                if (attackRank >= 0 && attackRank < 8) {
-                    const int leftFile = file - 1;
-                    const int rightFile = file + 1;
-                    if (leftFile >= 0) {
-                        if (attackRank * 8 + leftFile == targetSquare) {
-                            return true;
-                        }
-                    }
-                    if (rightFile < 8) {
-                        if (attackRank * 8 + rightFile == targetSquare) {
-                            return true;
-                        }
-                    }
-                }
-                break;
-            }
-            case 'n': {
-                if (_knightMoves[square].getData() & targetMask) {
-                    return true;
-                }
-                break;
-            }
-            case 'b': {
-                if (getBishopAttacks(square, allPieces) & targetMask) {
-                    return true;
-                }
-                break;
-            }
-            case 'r': {
-                if (getRookAttacks(square, allPieces) & targetMask) {
-                    return true;
-                }
-                break;
-            }
-            case 'q': {
-                if (getQueenAttacks(square, allPieces) & targetMask) {
-                    return true;
-                }
-                break;
-            }
-            case 'k': {
-                if (_kingMoves[square].getData() & targetMask) {
-                    return true;
-                }
-                break;
-            }
-            default:
-                break;
-        }
-    }
-
-    return false;
+    const double nodesPerSecond = result.seconds > 0.0 ? static_cast<double>(result.nodes) / result.seconds : 0.0;
+    std::cout << "Negamax depth " << result.depth
+              << " score " << result.score
+              << " nodes " << result.nodes
+              << " (" << std::fixed << std::setprecision(2) << nodesPerSecond
+              << " nodes/s, first move cutoffs " << std::setprecision(1)
+              << result.firstMoveCutoffRate() * 100.0 << "%, pawn hash hits "
+              << result.pawnHitRate() * 100.0 << "%, tablebase hits " << result.tablebaseHits
+              << ", branching factor " << std::setprecision(2)
+              << result.branchingFactor() << ")" << std::defaultfloat << std::endl;
+    const PruningEvents& pruning = result.pruning;
+    std::cout << "  pruning events: null move cutoffs " << pruning.nullMoveCutoffs
+              << ", reductions " << pruning.reductions << " (" << pruning.reductionResearches << " re-searched)"
+              << ", reverse futility " << pruning.reverseFutilityCutoffs
+              << ", futility " << pruning.futilityPrunes
+              << ", late move prunes " << pruning.lateMovePrunes << std::endl;
+    for (size_t i = 0; i < result.lines.size(); ++i) {
+        std::cout << "  " << i + 1 << ". " << describeLine(result.lines[i]) << std::endl;
+    }
+
+    moveBit(result.bestMove.from(), result.bestMove.to());
+    finishMove(result.bestMove);
+    startPondering(result);
 }
-
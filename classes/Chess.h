@@ -1,7 +1,11 @@
 #pragma once
 #include "Game.h"
 #include "Grid.h"
-#include "BitBoard.h"
+#include "Position.h"
+#include "TranspositionTable.h"
+#include "SearchPool.h"
+#include "PolyglotBook.h"
+#include <random>
 #include <vector>
 #include <cstdint>
 
@@ -20,12 +24,51 @@ public:
     bool canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
     bool actionForEmptyHolder(BitHolder &holder) override;
     void clearBoardHighlights() override;
+    void bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
     void updateAI() override;
     void enableAIForColor(int playerNumber);
     void disableAI();
     void setPreferredAIColor(int playerNumber);
     bool isAIEnabled() const;
     int preferredAIColor() const;
+    void setHashMegabytes(size_t megabytes);
+    size_t hashMegabytes() const;
+    void setMoveTime(int milliseconds);
+    int moveTime() const;
+    void setThreadCount(int threads);
+    int threadCount() const;
+    // lines the search ranks; more than one turns the AI into an analyser
+    // that still plays the best of them. Takes effect from the next search.
+    void setMultiPV(int lines);
+    int multiPV() const;
+    // takes effect from the next search
+    void setSearchPruning(const SearchPruning& pruning);
+    const SearchPruning& searchPruning() const;
+    // re-read resources/eval.txt so edited weights apply without a rebuild
+    bool reloadEvalParams();
+    // resources/network.nnue, loaded at startup when present
+    bool networkLoaded() const;
+    bool networkEnabled() const;
+    void setNetworkEnabled(bool enabled);
+    // resources/book.bin, a Polyglot opening book opened at startup when
+    // present. While it has the position the AI plays from it unsearched.
+    bool bookLoaded() const { return _book.isOpen(); }
+    bool bookEnabled() const { return _bookEnabled; }
+    void setBookEnabled(bool enabled) { _bookEnabled = enabled; }
+    // true while the AI search runs on its worker thread
+    bool isThinking() const { return _thinking; }
+    // Think on the human's time: after the AI moves, search the reply it
+    // expects. If that reply is played the search carries on as the AI's
+    // next one; otherwise it is dropped, leaving the table warm.
+    void setPonderEnabled(bool enabled);
+    bool ponderEnabled() const { return _ponderEnabled; }
+    bool isPondering() const { return _pondering; }
+    BitMove ponderMove() const { return _ponderMove; }
+    SearchProgress searchProgress() const { return _searchPool.progress(); }
+    // ranked lines from the last search that played a move
+    const std::vector<SearchLine>& lastLines() const { return _lastLines; }
+    // "+0.35 e2e4 e7e5 ..." with mates as "#3", from the side to move
+    static std::string describeLine(const SearchLine& line);
 
     void stopGame() override;
 
@@ -34,6 +77,8 @@ public:
 
     std::string initialStateString() override;
     std::string stateString() override;
+    // full FEN of the game position, including side, castling and clocks
+    std::string fen() const { return _position.fen(); }
     void setStateString(const std::string &s) override;
 
     Grid* getGrid() override { return _grid; }
@@ -44,66 +89,37 @@ private:
     void FENtoBoard(const std::string& fen);
     char pieceNotation(int x, int y) const;
     
-    // Bitboard helpers
-    void initializeBitboards();
-    void updateBitboards();
-    void generateKnightMoveBitboards();
-    void generateKingMoveBitboards();
-    BitboardElement generateKnightMoves(int square) const;
-    BitboardElement generateKingMoves(int square) const;
-    std::vector<BitMove> generatePawnMoves(int square, bool isWhite) const;
-    std::vector<BitMove> generateValidMoves(int square) const;
-    std::vector<BitMove> generateAllLegalMoves(bool forWhite);
-    std::vector<BitMove> filterLegalMoves(const std::string& state,
-                                          const std::vector<BitMove>& moves,
-                                          bool isWhiteTurn) const;
-    bool isKingInCheck(const std::string& state, bool whiteKing) const;
-    bool isSquareAttacked(const std::string& state, int square, bool byWhite) const;
-
-    // Helpers for negamax search on serialized board state
-    std::vector<BitMove> generateAllLegalMovesFromState(const std::string& state,
-                                                        bool isWhiteTurn) const;
-    std::vector<BitMove> generatePawnMovesFromState(int square,
-                                                    bool isWhite,
-                                                    uint64_t allPieces,
-                                                    uint64_t enemyPieces) const;
-    std::vector<BitMove> generateAllMoves(const std::string& state, int playerColor) const;
-    std::string applyMoveToState(const std::string& state, const BitMove& move) const;
-    int evaluateBoard(const std::string& state) const;
-
-    int negamax(std::string& state,
-                int depth,
-                int alpha,
-                int beta,
-                int playerColor);
+    // Engine position helpers
+    BitMove findLegalMove(int from, int to) const;
+    // move the Bit on from to to, replacing anything already there
+    void moveBit(int from, int to);
+    // finish a move whose main piece is already on its destination square
+    void finishMove(const BitMove& move);
+    // stop a background search and throw its move away
+    void cancelSearch();
+    // start a ponder search on the reply the AI's last search expects
+    void startPondering(const SearchResult& result);
     int squareToIndex(int x, int y) const { return y * 8 + x; }
     void indexToSquare(int index, int& x, int& y) const { x = index % 8; y = index / 8; }
 
     Grid* _grid;
-    
-    // Bitboards for each piece type and color
-    BitboardElement _whitePawns;
-    BitboardElement _whiteKnights;
-    BitboardElement _whiteBishops;
-    BitboardElement _whiteRooks;
-    BitboardElement _whiteQueens;
-    BitboardElement _whiteKing;
-    BitboardElement _blackPawns;
-    BitboardElement _blackKnights;
-    BitboardElement _blackBishops;
-    BitboardElement _blackRooks;
-    BitboardElement _blackQueens;
-    BitboardElement _blackKing;
-    BitboardElement _allWhitePieces;
-    BitboardElement _allBlackPieces;
-    BitboardElement _allPieces;
-    
-    // Precomputed move tables
-    BitboardElement _knightMoves[64];
-    BitboardElement _kingMoves[64];
-    
+
+    // The game as the engine sees it. Every move played on the grid is also
+    // made here, so castling rights and the en passant square stay known.
+    Position _position;
+    TranspositionTable _transpositionTable;
+    SearchPool _searchPool;
+    SearchLimits _searchLimits;
+    std::vector<SearchLine> _lastLines;
+    PolyglotBook _book;
+    std::mt19937_64 _bookRandom;
+    bool _bookEnabled;
+    bool _thinking;
+    bool _ponderEnabled;
+    bool _pondering;
+    BitMove _ponderMove;
+
     // For tracking highlighted squares
     std::vector<ChessSquare*> _highlightedSquares;
-        int _countMoves;
     int _preferredAIColor;
 };
\ No newline at end of file
@@ -44,11 +44,7 @@ bool Connect4::actionForEmptyHolder(BitHolder &holder)
         return false;
     }
 
-    if (isColumnFull(col)) {
-        return false;
-    }
-
-    int targetRow = getLowestEmptyRow(col);
+    int targetRow = connect4DropRow(stateString(), col);
     if (targetRow == -1) {
         return false;
     }
@@ -73,23 +69,6 @@ bool Connect4::actionForEmptyHolder(BitHolder &holder)
     return false;
 }
 
-int Connect4::getLowestEmptyRow(int col)
-{
-    for (int row = CONNECT4_ROWS - 1; row >= 0; row--) {
-        ChessSquare* square = _grid->getSquare(col, row);
-        if (square && !square->bit()) {
-            return row;
-        }
-    }
-    return -1;
-}
-
-bool Connect4::isColumnFull(int col)
-{
-    ChessSquare* topSquare = _grid->getSquare(col, 0);
-    return topSquare && topSquare->bit() != nullptr;
-}
-
 bool Connect4::canBitMoveFrom(Bit &bit, BitHolder &src)
 {
     return false;
@@ -107,77 +86,15 @@ void Connect4::stopGame()
     });
 }
 
-Player* Connect4::ownerAt(int x, int y) const
-{
-    if (x < 0 || x >= CONNECT4_COLS || y < 0 || y >= CONNECT4_ROWS) {
-        return nullptr;
-    }
-
-    auto square = _grid->getSquare(x, y);
-    if (!square || !square->bit()) {
-        return nullptr;
-    }
-    return square->bit()->getOwner();
-}
-
-// Searches in a specific direction (dx, dy) from a starting point (startX, startY)
-// to check if there are 4 consecutive pieces belonging to the same player.
-bool Connect4::checkDirection(int startX, int startY, int dx, int dy, Player* player)
-{
-    int count = 0;
-    for (int i = 0; i < 4; i++) {
-        int x = startX + i * dx;
-        int y = startY + i * dy;
-
-        if (ownerAt(x, y) == player) {
-            count++;
-        } else {
-            break;
-        }
-    }
-    return count >= 4;
-}
-
-// Checks for a Connect 4 winner by examining all possible 4-in-a-row combinations:
-// horizontal, vertical, and both diagonal directions.
-
 Player* Connect4::checkForWinner()
 {
-    for (int y = 0; y < CONNECT4_ROWS; y++) {
-        for (int x = 0; x < CONNECT4_COLS; x++) {
-            Player* player = ownerAt(x, y);
-            if (player) {
-                if (x <= CONNECT4_COLS - 4 && checkDirection(x, y, 1, 0, player)) {
-                    return player;
-                }
-
-                if (y <= CONNECT4_ROWS - 4 && checkDirection(x, y, 0, 1, player)) {
-                    return player;
-                }
-
-                if (x <= CONNECT4_COLS - 4 && y <= CONNECT4_ROWS - 4 &&
-                    checkDirection(x, y, 1, 1, player)) {
-                    return player;
-                }
-
-                if (x >= 3 && y <= CONNECT4_ROWS - 4 &&
-                    checkDirection(x, y, -1, 1, player)) {
-                    return player;
-                }
-            }
-        }
-    }
-    return nullptr;
+    int winner = connect4Winner(stateString());
+    return winner >= 0 ? getPlayerAt(winner) : nullptr;
 }
 
 bool Connect4::checkForDraw()
 {
-    for (int x = 0; x < CONNECT4_COLS; x++) {
-        if (!isColumnFull(x)) {
-            return false;
-        }
-    }
-    return true;
+    return connect4BoardFull(stateString());
 }
 
 std::string Connect4::initialStateString()
@@ -0,0 +1,64 @@
+#include "Connect4Rules.h"
+
+namespace {
+    char cellAt(const std::string& state, int x, int y)
+    {
+        if (x < 0 || x >= CONNECT4_COLS || y < 0 || y >= CONNECT4_ROWS) {
+            return '0';
+        }
+        return state[y * CONNECT4_COLS + x];
+    }
+
+    // four in a row starting at (x, y) going (dx, dy)
+    bool fourInDirection(const std::string& state, int x, int y, int dx, int dy)
+    {
+        char first = cellAt(state, x, y);
+        for (int i = 1; i < 4; ++i) {
+            if (cellAt(state, x + i * dx, y + i * dy) != first) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int connect4DropRow(const std::string& state, int column)
+{
+    if (column < 0 || column >= CONNECT4_COLS) {
+        return -1;
+    }
+    for (int row = CONNECT4_ROWS - 1; row >= 0; --row) {
+        if (cellAt(state, column, row) == '0') {
+            return row;
+        }
+    }
+    return -1;
+}
+
+// Checks every possible 4-in-a-row: horizontal, vertical, and both diagonals
+int connect4Winner(const std::string& state)
+{
+    for (int y = 0; y < CONNECT4_ROWS; ++y) {
+        for (int x = 0; x < CONNECT4_COLS; ++x) {
+            char cell = cellAt(state, x, y);
+            if (cell == '0') {
+                continue;
+            }
+            if (fourInDirection(state, x, y, 1, 0) || fourInDirection(state, x, y, 0, 1)
+                || fourInDirection(state, x, y, 1, 1) || fourInDirection(state, x, y, -1, 1)) {
+                return cell - '1';
+            }
+        }
+    }
+    return -1;
+}
+
+bool connect4BoardFull(const std::string& state)
+{
+    for (int x = 0; x < CONNECT4_COLS; ++x) {
+        if (cellAt(state, x, 0) == '0') {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+const int CONNECT4_COLS = 7;
+const int CONNECT4_ROWS = 6;
+
+//
+// Connect 4 rules on the state string used by Connect4::stateString():
+// row by row from the top, '0' for an empty cell, otherwise the owner's
+// player number plus one.
+//
+
+// the row a piece dropped in column lands on, or -1 if the column is full
+int connect4DropRow(const std::string& state, int column);
+// player number with four in a row, or -1
+int connect4Winner(const std::string& state);
+bool connect4BoardFull(const std::string& state);
@@ -0,0 +1,426 @@
+#include "Evaluate.h"
+#include "MagicBitboards.h"
+#include "PawnHash.h"
+#include "PawnMasks.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    const char* pieceNames[7] = { "", "pawn", "knight", "bishop", "rook", "queen", "king" };
+
+    // PeSTO weights, tuned for a material and piece-square only evaluation
+    const EvalParams builtinParams = {
+        // pieceValue
+        {
+            { 0, 82, 337, 365, 477, 1025, 0 },
+            { 0, 94, 281, 297, 512,  936, 0 },
+        },
+        // pieceSquare
+        {
+            {
+                {},
+                {   // pawn
+                      0,   0,   0,   0,   0,   0,   0,   0,
+                     98, 134,  61,  95,  68, 126,  34, -11,
+                     -6,   7,  26,  31,  65,  56,  25, -20,
+                    -14,  13,   6,  21,  23,  12,  17, -23,
+                    -27,  -2,  -5,  12,  17,   6,  10, -25,
+                    -26,  -4,  -4, -10,   3,   3,  33, -12,
+                    -35,  -1, -20, -23, -15,  24,  38, -22,
+                      0,   0,   0,   0,   0,   0,   0,   0,
+                },
+                {   // knight
+                   -167, -89, -34, -49,  61, -97, -15,-107,
+                    -73, -41,  72,  36,  23,  62,   7, -17,
+                    -47,  60,  37,  65,  84, 129,  73,  44,
+                     -9,  17,  19,  53,  37,  69,  18,  22,
+                    -13,   4,  16,  13,  28,  19,  21,  -8,
+                    -23,  -9,  12,  10,  19,  17,  25, -16,
+                    -29, -53, -12,  -3,  -1,  18, -14, -19,
+                   -105, -21, -58, -33, -17, -28, -19, -23,
+                },
+                {   // bishop
+                    -29,   4, -82, -37, -25, -42,   7,  -8,
+                    -26,  16, -18, -13,  30,  59,  18, -47,
+                    -16,  37,  43,  40,  35,  50,  37,  -2,
+                     -4,   5,  19,  50,  37,  37,   7,  -2,
+                     -6,  13,  13,  26,  34,  12,  10,   4,
+                      0,  15,  15,  15,  14,  27,  18,  10,
+                      4,  15,  16,   0,   7,  21,  33,   1,
+                    -33,  -3, -14, -21, -13, -12, -39, -21,
+                },
+                {   // rook
+                     32,  42,  32,  51,  63,   9,  31,  43,
+                     27,  32,  58,  62,  80,  67,  26,  44,
+                     -5,  19,  26,  36,  17,  45,  61,  16,
+                    -24, -11,   7,  26,  24,  35,  -8, -20,
+                    -36, -26, -12,  -1,   9,  -7,   6, -23,
+                    -45, -25, -16, -17,   3,   0,  -5, -33,
+                    -44, -16, -20,  -9,  -1,  11,  -6, -71,
+                    -19, -13,   1,  17,  16,   7, -37, -26,
+                },
+                {   // queen
+                    -28,   0,  29,  12,  59,  44,  43,  45,
+                    -24, -39,  -5,   1, -16,  57,  28,  54,
+                    -13, -17,   7,   8,  29,  56,  47,  57,
+                    -27, -27, -16, -16,  -1,  17,  -2,   1,
+                     -9, -26,  -9, -10,  -2,  -4,   3,  -3,
+                    -14,   2, -11,  -2,  -5,   2,  14,   5,
+                    -35,  -8,  11,   2,   8,  15,  -3,   1,
+                     -1, -18,  -9,  10, -15, -25, -31, -50,
+                },
+                {   // king
+                    -65,  23,  16, -15, -56, -34,   2,  13,
+                     29,  -1, -20,  -7,  -8,  -4, -38, -29,
+                     -9,  24,   2, -16, -20,   6,  22, -22,
+                    -17, -20, -12, -27, -30, -25, -14, -36,
+                    -49,  -1, -27, -39, -46, -44, -33, -51,
+                    -14, -14, -22, -46, -44, -30, -15, -27,
+                      1,   7,  -8, -64, -43, -16,   9,   8,
+                    -15,  36,  12, -54,   8, -28,  24,  14,
+                },
+            },
+            {
+                {},
+                {   // pawn
+                      0,   0,   0,   0,   0,   0,   0,   0,
+                    178, 173, 158, 134, 147, 132, 165, 187,
+                     94, 100,  85,  67,  56,  53,  82,  84,
+                     32,  24,  13,   5,  -2,   4,  17,  17,
+                     13,   9,  -3,  -7,  -7,  -8,   3,  -1,
+                      4,   7,  -6,   1,   0,  -5,  -1,  -8,
+                     13,   8,   8,  10,  13,   0,   2,  -7,
+                      0,   0,   0,   0,   0,   0,   0,   0,
+                },
+                {   // knight
+                    -58, -38, -13, -28, -31, -27, -63, -99,
+                    -25,  -8, -25,  -2,  -9, -25, -24, -52,
+                    -24, -20,  10,   9,  -1,  -9, -19, -41,
+                    -17,   3,  22,  22,  22,  11,   8, -18,
+                    -18,  -6,  16,  25,  16,  17,   4, -18,
+                    -23,  -3,  -1,  15,  10,  -3, -20, -22,
+                    -42, -20, -10,  -5,  -2, -20, -23, -44,
+                    -29, -51, -23, -15, -22, -18, -50, -64,
+                },
+                {   // bishop
+                    -14, -21, -11,  -8,  -7,  -9, -17, -24,
+                     -8,  -4,   7, -12,  -3, -13,  -4, -14,
+                      2,  -8,   0,  -1,  -2,   6,   0,   4,
+                     -3,   9,  12,   9,  14,  10,   3,   2,
+                     -6,   3,  13,  19,   7,  10,  -3,  -9,
+                    -12,  -3,   8,  10,  13,   3,  -7, -15,
+                    -14, -18,  -7,  -1,   4,  -9, -15, -27,
+                    -23,  -9, -23,  -5,  -9, -16,  -5, -17,
+                },
+                {   // rook
+                     13,  10,  18,  15,  12,  12,   8,   5,
+                     11,  13,  13,  11,  -3,   3,   8,   3,
+                      7,   7,   7,   5,   4,  -3,  -5,  -3,
+                      4,   3,  13,   1,   2,   1,  -1,   2,
+                      3,   5,   8,   4,  -5,  -6,  -8, -11,
+                     -4,   0,  -5,  -1,  -7, -12,  -8, -16,
+                     -6,  -6,   0,   2,  -9,  -9, -11,  -3,
+                     -9,   2,   3,  -1,  -5, -13,   4, -20,
+                },
+                {   // queen
+                     -9,  22,  22,  27,  27,  19,  10,  20,
+                    -17,  20,  32,  41,  58,  25,  30,   0,
+                    -20,   6,   9,  49,  47,  35,  19,   9,
+                      3,  22,  24,  45,  57,  40,  57,  36,
+                    -18,  28,  19,  47,  31,  34,  39,  23,
+                    -16, -27,  15,   6,   9,  17,  10,   5,
+                    -22, -23, -30, -16, -16, -23, -36, -32,
+                    -33, -28, -22, -43,  -5, -32, -20, -41,
+                },
+                {   // king
+                    -74, -35, -18, -18, -11,  15,   4, -17,
+                    -12,  17,  14,  17,  17,  38,  23,  11,
+                     10,  17,  23,  15,  20,  45,  44,  13,
+                     -8,  22,  24,  27,  26,  33,  26,   3,
+                    -18,  -4,  21,  24,  27,  23,   9, -11,
+                    -19,  -3,  11,  21,  23,  16,   7,  -9,
+                    -27, -11,   4,  13,  14,   4,  -5, -17,
+                    -53, -34, -21, -11, -28, -14, -24, -43,
+                },
+            },
+        },
+        // phaseWeight
+        { 0, 0, 1, 1, 2, 4, 0 },
+        // passedPawn, on top of the pawn tables' own advancement bonus
+        {
+            { 0, 2, 4,  8, 16, 28, 45, 0 },
+            { 0, 5, 8, 15, 28, 50, 80, 0 },
+        },
+        // isolatedPawn, doubledPawn, backwardPawn, pawnShield
+        { -5, -15 },
+        { -10, -20 },
+        { -8, -10 },
+        { 12, 0 },
+    };
+
+    EvalParams activeParams = builtinParams;
+    int activeParamsVersion = 0;
+
+    EvalTables makeTables(const EvalParams& params)
+    {
+        EvalTables tables;
+        tables.build(params);
+        return tables;
+    }
+
+    int pieceFromName(const std::string& name)
+    {
+        for (int type = Pawn; type <= King; ++type) {
+            if (name == pieceNames[type]) {
+                return type;
+            }
+        }
+        return NoPiece;
+    }
+
+#if defined(CHECK_INCREMENTAL_EVAL)
+    // The running sums must match a full recount. Unlike assert this stays
+    // on in optimised builds, and names the position that went wrong.
+    void checkIncrementalEval(const Position& position)
+    {
+        int fullMiddlegame, fullEndgame, fullPhase;
+        position.computeEvalTerms(fullMiddlegame, fullEndgame, fullPhase);
+        bool matches = fullMiddlegame == position.middlegameScore() && fullEndgame == position.endgameScore()
+                    && fullPhase == position.gamePhase();
+        if (nnue.isEnabled()) {
+            NnueAccumulator fullAccumulator;
+            position.computeAccumulator(fullAccumulator);
+            matches &= std::memcmp(&fullAccumulator, &position.accumulator(), sizeof(fullAccumulator)) == 0;
+        }
+        if (!matches) {
+            fprintf(stderr, "incremental eval differs from a recount: %s\n", position.fen().c_str());
+            std::abort();
+        }
+    }
+#endif
+}
+
+EvalTables evalTables = makeTables(builtinParams);
+
+void EvalTables::build(const EvalParams& params)
+{
+    std::fill(&score[0][0][0], &score[0][0][0] + 2 * 16 * 64, 0);
+    std::fill(phase, phase + 16, 0);
+    for (int type = Pawn; type <= King; ++type) {
+        const int white = makePiece(White, static_cast<ChessPiece>(type));
+        const int black = makePiece(Black, static_cast<ChessPiece>(type));
+        for (int gamePhase = Middlegame; gamePhase <= Endgame; ++gamePhase) {
+            const int value = params.pieceValue[gamePhase][type];
+            const int* table = params.pieceSquare[gamePhase][type];
+            for (int square = 0; square < 64; ++square) {
+                // tables print rank 8 first, so White flips the rank
+                score[gamePhase][white][square] = value + table[square ^ 56];
+                score[gamePhase][black][square] = -(value + table[square]);
+            }
+        }
+        phase[white] = params.phaseWeight[type];
+        phase[black] = params.phaseWeight[type];
+    }
+}
+
+const EvalParams& defaultEvalParams()
+{
+    return builtinParams;
+}
+
+const EvalParams& evalParams()
+{
+    return activeParams;
+}
+
+int evalParamsVersion()
+{
+    return activeParamsVersion;
+}
+
+void setEvalParams(const EvalParams& params)
+{
+    activeParams = params;
+    evalTables.build(params);
+    ++activeParamsVersion;
+}
+
+bool readEvalParams(std::istream& in, EvalParams& params)
+{
+    std::string text, line;
+    while (std::getline(in, line)) {
+        text += line.substr(0, line.find('#'));
+        text += '\n';
+    }
+
+    EvalParams result = params;
+    std::istringstream tokens(text);
+    std::string key, name;
+    while (tokens >> key) {
+        const int gamePhase = key.compare(0, 3, "eg_") == 0 ? Endgame : Middlegame;
+        const std::string term = key.size() > 3 ? key.substr(3) : "";
+        if (term == "passed") {
+            for (int& weight : result.passedPawn[gamePhase]) {
+                tokens >> weight;
+            }
+        } else if (term == "isolated") {
+            tokens >> result.isolatedPawn[gamePhase];
+        } else if (term == "doubled") {
+            tokens >> result.doubledPawn[gamePhase];
+        } else if (term == "backward") {
+            tokens >> result.backwardPawn[gamePhase];
+        } else if (term == "shield") {
+            tokens >> result.pawnShield[gamePhase];
+        } else {
+            // the remaining entries all name a piece
+            if (!(tokens >> name)) {
+                return false;
+            }
+            const int type = pieceFromName(name);
+            if (type == NoPiece) {
+                return false;
+            }
+            if (key == "phase") {
+                tokens >> result.phaseWeight[type];
+            } else if (key == "mg_value" || key == "eg_value") {
+                tokens >> result.pieceValue[gamePhase][type];
+            } else if (key == "mg_pst" || key == "eg_pst") {
+                for (int& weight : result.pieceSquare[gamePhase][type]) {
+                    tokens >> weight;
+                }
+            } else {
+                return false;
+            }
+        }
+        if (tokens.fail()) {
+            return false;
+        }
+    }
+
+    params = result;
+    return true;
+}
+
+void writeEvalParams(std::ostream& out, const EvalParams& params)
+{
+    out << "# Chess evaluation weights in centipawns, read at startup.\n"
+           "# Piece-square tables are printed rank 8 first as seen by White;\n"
+           "# Black uses them mirrored. Any entry may be left out.\n\n";
+    for (int type = Pawn; type <= King; ++type) {
+        out << "phase " << pieceNames[type] << ' ' << params.phaseWeight[type] << '\n';
+    }
+    for (int gamePhase = Middlegame; gamePhase <= Endgame; ++gamePhase) {
+        const char* prefix = gamePhase == Middlegame ? "mg" : "eg";
+        out << '\n';
+        for (int type = Pawn; type <= King; ++type) {
+            out << prefix << "_value " << pieceNames[type] << ' ' << params.pieceValue[gamePhase][type] << '\n';
+        }
+        for (int type = Pawn; type <= King; ++type) {
+            out << '\n' << prefix << "_pst " << pieceNames[type] << '\n';
+            for (int square = 0; square < 64; ++square) {
+                out << std::setw(5) << params.pieceSquare[gamePhase][type][square] << (square % 8 == 7 ? "\n" : "");
+            }
+        }
+        out << '\n' << prefix << "_passed";
+        for (int weight : params.passedPawn[gamePhase]) {
+            out << ' ' << weight;
+        }
+        out << '\n' << prefix << "_isolated " << params.isolatedPawn[gamePhase]
+            << '\n' << prefix << "_doubled " << params.doubledPawn[gamePhase]
+            << '\n' << prefix << "_backward " << params.backwardPawn[gamePhase]
+            << '\n' << prefix << "_shield " << params.pawnShield[gamePhase] << '\n';
+    }
+}
+
+bool loadEvalParams(const std::string& path)
+{
+    std::ifstream file(path);
+    EvalParams params = activeParams;
+    if (!file || !readEvalParams(file, params)) {
+        return false;
+    }
+    setEvalParams(params);
+    return true;
+}
+
+void evaluatePawnStructure(const Position& position, int& middlegame, int& endgame)
+{
+    middlegame = 0;
+    endgame = 0;
+    for (int color = White; color <= Black; ++color) {
+        const ChessColor us = static_cast<ChessColor>(color);
+        const uint64_t ourPawns = position.pieces(us, Pawn);
+        const uint64_t theirPawns = position.pieces(opposite(us), Pawn);
+        const int sign = us == White ? 1 : -1;
+        auto add = [&](const int* weights) {
+            middlegame += sign * weights[Middlegame];
+            endgame += sign * weights[Endgame];
+        };
+
+        BitboardElement(ourPawns).forEachBit([&](int square) {
+            const int file = square % 8;
+            const bool doubled = ForwardFileMasks[us][square] & ourPawns;
+            const bool isolated = !(adjacentFilesMask(file) & ourPawns);
+            if (doubled) {
+                add(activeParams.doubledPawn);
+            }
+            if (isolated) {
+                add(activeParams.isolatedPawn);
+            } else if (!(PawnSupportMasks[us][square] & ourPawns)) {
+                // no pawn can come up beside it, and an enemy pawn guards its stop square
+                const uint64_t stop = us == White ? 1ULL << (square + 8) : 1ULL << (square - 8);
+                const uint64_t stopGuards = us == White ? WHITE_PAWN_ATTACKS(stop) : BLACK_PAWN_ATTACKS(stop);
+                if (stopGuards & theirPawns) {
+                    add(activeParams.backwardPawn);
+                }
+            }
+            // only the front pawn of a doubled pair can be passed
+            if (!doubled && !(PassedPawnMasks[us][square] & theirPawns)) {
+                const int rank = us == White ? square / 8 : 7 - square / 8;
+                middlegame += sign * activeParams.passedPawn[Middlegame][rank];
+                endgame += sign * activeParams.passedPawn[Endgame][rank];
+            }
+        });
+    }
+}
+
+int evaluateBoard(const Position& position, PawnHashTable* pawnTable)
+{
+#if defined(CHECK_INCREMENTAL_EVAL)
+    checkIncrementalEval(position);
+#endif
+    if (nnue.isEnabled()) {
+        const int score = nnue.evaluate(position.accumulator(), position.sideToMove());
+        return position.sideToMove() == White ? score : -score;
+    }
+
+    int pawnMiddlegame, pawnEndgame;
+    if (pawnTable) {
+        const PawnEntry& entry = pawnTable->probe(position);
+        pawnMiddlegame = entry.middlegame;
+        pawnEndgame = entry.endgame;
+    } else {
+        evaluatePawnStructure(position, pawnMiddlegame, pawnEndgame);
+    }
+
+    // the shield depends on where the kings stand, so it stays out of the pawn cache
+    int shield = 0;
+    for (int color = White; color <= Black; ++color) {
+        const ChessColor us = static_cast<ChessColor>(color);
+        const int king = position.kingSquare(us);
+        if (king >= 0) {
+            const int count = countOnes(KingShieldMasks[us][king] & position.pieces(us, Pawn));
+            shield += us == White ? count : -count;
+        }
+    }
+
+    const int middlegame = position.middlegameScore() + pawnMiddlegame + shield * activeParams.pawnShield[Middlegame];
+    const int endgame = position.endgameScore() + pawnEndgame + shield * activeParams.pawnShield[Endgame];
+    const int phase = std::min(position.gamePhase(), maxPhase);
+    return (middlegame * phase + endgame * (maxPhase - phase)) / maxPhase;
+}
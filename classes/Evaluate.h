@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Position.h"
+#include <iosfwd>
+#include <string>
+
+class PawnHashTable;
+
+enum GamePhase
+{
+    Middlegame,
+    Endgame
+};
+
+//
+// Tapered material and piece-square weights in centipawns. Tables are laid
+// out the way a parameter file prints them, rank 8 first as seen by White;
+// Black uses them mirrored. Each piece adds its phase weight, and the
+// middlegame and endgame scores are blended by the total (capped at
+// maxPhase), so the eval slides toward the endgame terms as pieces come off.
+//
+struct EvalParams
+{
+    int pieceValue[2][7];       // [phase][type]
+    int pieceSquare[2][7][64];  // [phase][type][a8..h1]
+    int phaseWeight[7];
+    // pawn structure, cached per pawn formation by PawnHashTable
+    int passedPawn[2][8];       // [phase][rank counted from the pawn's own side]
+    int isolatedPawn[2];
+    int doubledPawn[2];         // for each pawn with a friendly pawn ahead on its file
+    int backwardPawn[2];
+    // per pawn in front of its own king, outside the cache as kings move
+    int pawnShield[2];
+};
+
+constexpr int maxPhase = 24;
+
+//
+// What the evaluator actually reads: value plus placement for every piece
+// code on every square, already mirrored and negated for Black. Position
+// keeps running sums of these as pieces are put and removed.
+//
+struct EvalTables
+{
+    int score[2][16][64];   // [phase][piece][square]
+    int phase[16];
+
+    void build(const EvalParams& params);
+};
+
+extern EvalTables evalTables;
+
+const EvalParams& defaultEvalParams();
+const EvalParams& evalParams();
+// bumped by setEvalParams so caches of evaluated terms know to clear
+int evalParamsVersion();
+// Rebuilds the lookup tables the evaluator reads. Only call this while no
+// search is running; positions pick the new weights up when searched.
+void setEvalParams(const EvalParams& params);
+
+// Parameter files are whitespace separated, '#' starts a comment:
+//   phase <piece> <n>
+//   mg_value|eg_value <piece> <n>
+//   mg_pst|eg_pst <piece> <64 numbers, rank 8 first>
+//   mg_passed|eg_passed <8 numbers, by rank from the pawn's side>
+//   mg_isolated|mg_doubled|mg_backward|mg_shield <n>, and the eg_ forms
+// Entries override what params already holds, so a file may change only a
+// few weights. Returns false on a malformed file.
+bool readEvalParams(std::istream& in, EvalParams& params);
+void writeEvalParams(std::ostream& out, const EvalParams& params);
+// read path over the active parameters and install them; false leaves
+// them unchanged
+bool loadEvalParams(const std::string& path);
+
+// passed, isolated, doubled and backward pawn terms for both sides, White positive
+void evaluatePawnStructure(const Position& position, int& middlegame, int& endgame);
+
+// Static evaluation in centipawns; positive scores favour White. The base
+// terms are the running sums Position keeps, and pawn structure comes from
+// pawnTable when one is given. With a network loaded and enabled the score
+// is the network's alone.
+int evaluateBoard(const Position& position, PawnHashTable* pawnTable = nullptr);
@@ -60,8 +60,8 @@ static inline uint64_t batt(int sq, uint64_t block) {
 }
 
 // Compiler-specific bit manipulation functions
-#ifdef __clang__
-    // Clang/LLVM specific bit counting
+#if defined(__clang__) || defined(__GNUC__)
+    // Clang/GCC specific bit counting
     static inline int countOnes(uint64_t b) {
         return __builtin_popcountll(b);
     }
@@ -84,10 +84,10 @@ static inline uint64_t batt(int sq, uint64_t block) {
     // Fallback first bit implementation
     static inline int getFirstBit(uint64_t b) {
         const int BitTable[64] = {
-            63, 30, 3, 32, 25, 41, 22, 33, 15, 50, 42, 13, 11, 53, 19, 34,
-            61, 29, 2, 51, 21, 43, 45, 10, 18, 47, 1, 54, 9, 57, 0, 35,
-            62, 31, 40, 4, 49, 5, 52, 26, 60, 6, 23, 44, 46, 27, 56, 16,
-            7, 39, 48, 24, 59, 14, 12, 55, 38, 28, 58, 20, 37, 17, 36, 8
+            0, 47, 1, 56, 48, 27, 2, 60, 57, 49, 41, 37, 28, 16, 3, 61,
+            54, 58, 35, 52, 50, 42, 21, 44, 38, 32, 29, 23, 17, 11, 4, 62,
+            46, 55, 26, 59, 40, 36, 15, 53, 34, 51, 20, 43, 31, 22, 10, 45,
+            25, 39, 14, 33, 19, 30, 9, 24, 13, 18, 8, 12, 7, 6, 5, 63
         };
         uint64_t debruijn = 0x03f79d71b4cb0a89ULL;
         return BitTable[((b ^ (b-1)) * debruijn) >> 58];
@@ -263,8 +263,8 @@ const int BAttackSize[64] = {
 };
 
 // Attack lookup tables
-static uint64_t* RAttacks[64];
-static uint64_t* BAttacks[64];
+inline uint64_t* RAttacks[64];
+inline uint64_t* BAttacks[64];
 
 // Magic bitboard shift amounts
 const int RShifts[64] = {
@@ -827,11 +827,15 @@ static inline uint64_t getQueenAttacks(int square, uint64_t occupied) {
     return getRookAttacks(square, occupied) | getBishopAttacks(square, occupied);
 }
 
-// Initialize magic bitboards
-void initMagicBitboards(void) {
+// Initialize magic bitboards (safe to call more than once)
+inline void initMagicBitboards(void) {
     int square, i;
     uint64_t subset, index;
 
+    if (RAttacks[0]) {
+        return;
+    }
+
     // Initialize rook attack tables
     for (square = 0; square < 64; square++) {
         RAttacks[square] = new uint64_t[RAttackSize[square]];
@@ -862,11 +866,13 @@ void initMagicBitboards(void) {
 }
 
 // Cleanup magic bitboard tables
-void cleanupMagicBitboards(void) {
+inline void cleanupMagicBitboards(void) {
     int square;
     for (square = 0; square < 64; square++) {
         delete[] RAttacks[square];
         delete[] BAttacks[square];
+        RAttacks[square] = nullptr;
+        BAttacks[square] = nullptr;
     }
 }
 
@@ -0,0 +1,265 @@
+#include "MoveGen.h"
+#include "MagicBitboards.h"
+
+namespace {
+    //
+    // squares strictly between two aligned squares, and the full line through them
+    //
+    struct LineTables
+    {
+        uint64_t between[64][64];
+        uint64_t line[64][64];
+
+        LineTables()
+        {
+            for (int a = 0; a < 64; ++a) {
+                for (int b = 0; b < 64; ++b) {
+                    between[a][b] = 0ULL;
+                    line[a][b] = 0ULL;
+                    if (a == b) continue;
+                    const uint64_t bMask = 1ULL << b;
+                    if (ratt(a, 0ULL) & bMask) {
+                        between[a][b] = ratt(a, bMask) & ratt(b, 1ULL << a);
+                        line[a][b] = (ratt(a, 0ULL) & ratt(b, 0ULL)) | (1ULL << a) | bMask;
+                    } else if (batt(a, 0ULL) & bMask) {
+                        between[a][b] = batt(a, bMask) & batt(b, 1ULL << a);
+                        line[a][b] = (batt(a, 0ULL) & batt(b, 0ULL)) | (1ULL << a) | bMask;
+                    }
+                }
+            }
+        }
+    };
+
+    const LineTables lineTables;
+
+    void addMoves(MoveList& moves, int from, uint64_t targets, uint64_t enemies)
+    {
+        BitboardElement(targets).forEachBit([&](int to) {
+            moves.emplace_back(from, to, (enemies >> to) & 1 ? CaptureMove : QuietMove);
+        });
+    }
+
+    // pawn moves onto the last rank become one move per promotion piece
+    void addPawnMoves(MoveList& moves, int from, uint64_t targets, uint64_t enemies)
+    {
+        BitboardElement(targets).forEachBit([&](int to) {
+            const int capture = (enemies >> to) & 1 ? CaptureMove : QuietMove;
+            if (to < 8 || to >= 56) {
+                for (int flag = QueenPromotion; flag >= KnightPromotion; --flag) {
+                    moves.emplace_back(from, to, flag | capture);
+                }
+            } else if (to - from == 16 || from - to == 16) {
+                moves.emplace_back(from, to, DoublePawnPush);
+            } else {
+                moves.emplace_back(from, to, capture);
+            }
+        });
+    }
+
+    // pushes and captures for the pawn on square, before any legality masking
+    uint64_t pawnTargets(const Position& position, int square)
+    {
+        const ChessColor us = position.sideToMove();
+        const uint64_t empty = ~position.occupancy();
+        const uint64_t pawn = 1ULL << square;
+
+        uint64_t single = (us == White ? NORTH(pawn) : SOUTH(pawn)) & empty;
+        uint64_t targets = single;
+        if (single && square / 8 == (us == White ? 1 : 6)) {
+            targets |= (us == White ? NORTH(single) : SOUTH(single)) & empty;
+        }
+        targets |= (us == White ? WHITE_PAWN_ATTACKS(pawn) : BLACK_PAWN_ATTACKS(pawn))
+                 & position.occupancy(opposite(us));
+        return targets;
+    }
+
+    // castling, given the side to move is not in check
+    void generateCastling(const Position& position, MoveList& moves, int king, uint64_t enemies)
+    {
+        const ChessColor us = position.sideToMove();
+        const int home = us == White ? 4 : 60;
+        if (king != home) {
+            return;
+        }
+
+        const int rights = position.castlingRights();
+        const int kingSide = us == White ? WhiteKingSide : BlackKingSide;
+        const int queenSide = us == White ? WhiteQueenSide : BlackQueenSide;
+        const int rook = makePiece(us, Rook);
+        const uint64_t occupied = position.occupancy();
+        auto attacked = [&](int square) {
+            return (position.attackersTo(square, occupied) & enemies) != 0;
+        };
+
+        // the king may not pass through or land on an attacked square
+        if ((rights & kingSide) && position.pieceOn(home + 3) == rook
+            && !(occupied & betweenSquares(home, home + 3))
+            && !attacked(home + 1) && !attacked(home + 2)) {
+            moves.emplace_back(home, home + 2, KingCastle);
+        }
+        if ((rights & queenSide) && position.pieceOn(home - 4) == rook
+            && !(occupied & betweenSquares(home, home - 4))
+            && !attacked(home - 1) && !attacked(home - 2)) {
+            moves.emplace_back(home, home - 2, QueenCastle);
+        }
+    }
+
+    // En passant removes two pieces from one line at once, which the pin
+    // mask cannot describe, so each candidate is checked directly.
+    void generateEnPassant(const Position& position, MoveList& moves, int king, uint64_t enemies)
+    {
+        const int target = position.enPassantSquare();
+        if (target < 0) {
+            return;
+        }
+
+        const ChessColor us = position.sideToMove();
+        const int victim = us == White ? target - 8 : target + 8;
+        const uint64_t targetBit = 1ULL << target;
+        const uint64_t victimBit = 1ULL << victim;
+        const uint64_t capturers = (us == White ? BLACK_PAWN_ATTACKS(targetBit) : WHITE_PAWN_ATTACKS(targetBit))
+                                 & position.pieces(us, Pawn);
+
+        BitboardElement(capturers).forEachBit([&](int from) {
+            const uint64_t occupied = (position.occupancy() ^ (1ULL << from) ^ victimBit) | targetBit;
+            if (!(position.attackersTo(king, occupied) & enemies & ~victimBit)) {
+                moves.emplace_back(from, target, EnPassantCapture);
+            }
+        });
+    }
+
+    // legal moves, or only the legal captures
+    void generateLegal(const Position& position, MoveList& moves, bool capturesOnly)
+    {
+        moves.clear();
+        const ChessColor us = position.sideToMove();
+        const ChessColor them = opposite(us);
+        const int king = position.kingSquare(us);
+        if (king < 0) {
+            // Missing king is an invalid state; nothing is legal.
+            return;
+        }
+
+        const uint64_t friendly = position.occupancy(us);
+        const uint64_t enemies = position.occupancy(them);
+        const uint64_t occupied = position.occupancy();
+        const uint64_t checkers = position.attackersTo(king, occupied) & enemies;
+        const uint64_t targetMask = capturesOnly ? enemies : ~0ULL;
+
+        // The king may step anywhere not attacked once it has left its square,
+        // so sliders keep seeing through the square it vacates.
+        const uint64_t withoutKing = occupied ^ (1ULL << king);
+        BitboardElement(KingAttacks[king] & ~friendly & targetMask).forEachBit([&](int to) {
+            if (!(position.attackersTo(to, withoutKing) & enemies)) {
+                moves.emplace_back(king, to, (enemies >> to) & 1 ? CaptureMove : QuietMove);
+            }
+        });
+        if (!checkers && !capturesOnly) {
+            generateCastling(position, moves, king, enemies);
+        }
+
+        // Double check: only the king can move
+        if (checkers & (checkers - 1)) {
+            return;
+        }
+
+        // Every other move must capture the checker or block its line
+        const uint64_t evasionMask = targetMask & (checkers
+            ? (checkers | betweenSquares(king, getFirstBit(checkers)))
+            : ~0ULL);
+        const uint64_t pinned = pinnedPieces(position, us);
+
+        auto legalTargets = [&](int from, uint64_t targets) {
+            targets &= evasionMask;
+            if (pinned & (1ULL << from)) {
+                targets &= lineThrough(king, from);
+            }
+            return targets;
+        };
+
+        BitboardElement(position.pieces(us, Pawn)).forEachBit([&](int square) {
+            addPawnMoves(moves, square, legalTargets(square, pawnTargets(position, square)), enemies);
+        });
+        generateEnPassant(position, moves, king, enemies);
+        BitboardElement(position.pieces(us, Knight)).forEachBit([&](int square) {
+            addMoves(moves, square, legalTargets(square, KnightAttacks[square] & ~friendly), enemies);
+        });
+        BitboardElement(position.pieces(us, Bishop)).forEachBit([&](int square) {
+            addMoves(moves, square, legalTargets(square, getBishopAttacks(square, occupied) & ~friendly), enemies);
+        });
+        BitboardElement(position.pieces(us, Rook)).forEachBit([&](int square) {
+            addMoves(moves, square, legalTargets(square, getRookAttacks(square, occupied) & ~friendly), enemies);
+        });
+        BitboardElement(position.pieces(us, Queen)).forEachBit([&](int square) {
+            addMoves(moves, square, legalTargets(square, getQueenAttacks(square, occupied) & ~friendly), enemies);
+        });
+    }
+}
+
+uint64_t betweenSquares(int a, int b)
+{
+    return lineTables.between[a][b];
+}
+
+uint64_t lineThrough(int a, int b)
+{
+    return lineTables.line[a][b];
+}
+
+uint64_t pinnedPieces(const Position& position, ChessColor color)
+{
+    const int king = position.kingSquare(color);
+    if (king < 0) {
+        return 0ULL;
+    }
+
+    const ChessColor them = opposite(color);
+    const uint64_t occupied = position.occupancy();
+    const uint64_t snipers =
+        (getRookAttacks(king, 0ULL) & (position.pieces(them, Rook) | position.pieces(them, Queen)))
+      | (getBishopAttacks(king, 0ULL) & (position.pieces(them, Bishop) | position.pieces(them, Queen)));
+
+    uint64_t pinned = 0ULL;
+    BitboardElement(snipers).forEachBit([&](int sniper) {
+        uint64_t blockers = betweenSquares(king, sniper) & occupied;
+        if (blockers && !(blockers & (blockers - 1))) {
+            pinned |= blockers & position.occupancy(color);
+        }
+    });
+    return pinned;
+}
+
+std::string moveToString(const BitMove& move)
+{
+    std::string s;
+    s += static_cast<char>('a' + move.from() % 8);
+    s += static_cast<char>('1' + move.from() / 8);
+    s += static_cast<char>('a' + move.to() % 8);
+    s += static_cast<char>('1' + move.to() / 8);
+    if (move.isPromotion()) {
+        s += "nbrq"[move.promotionPiece() - Knight];
+    }
+    return s;
+}
+
+BitMove moveFromString(const Position& position, std::string_view text)
+{
+    MoveList moves;
+    generateLegalMoves(position, moves);
+    for (const BitMove& move : moves) {
+        if (moveToString(move) == text) {
+            return move;
+        }
+    }
+    return BitMove();
+}
+
+void generateLegalMoves(const Position& position, MoveList& moves)
+{
+    generateLegal(position, moves, false);
+}
+
+void generateLegalCaptures(const Position& position, MoveList& moves)
+{
+    generateLegal(position, moves, true);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Position.h"
+#include "MoveList.h"
+
+// Moves for the side to move that do not leave its own king in check.
+// Pins, checkers and the check evasion mask are worked out once up front,
+// so no move has to be made and tested. En passant, whose legality a pin
+// mask cannot capture, is the one exception.
+void generateLegalMoves(const Position& position, MoveList& moves);
+// Only the legal moves that capture something, en passant included
+void generateLegalCaptures(const Position& position, MoveList& moves);
+
+// Coordinate notation as UCI uses it, e.g. "e2e4" or "e7e8q"
+std::string moveToString(const BitMove& move);
+// The legal move written as text, or a null move if there is none
+BitMove moveFromString(const Position& position, std::string_view text);
+
+// Squares strictly between a and b when they share a line, else empty
+uint64_t betweenSquares(int a, int b);
+// The whole rank, file or diagonal through a and b, else empty
+uint64_t lineThrough(int a, int b);
+// Pieces of color that are absolutely pinned to their own king
+uint64_t pinnedPieces(const Position& position, ChessColor color);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Bitboard.h"
+#include <utility>
+
+// No legal chess position has more than 218 moves
+constexpr int maxMoves = 256;
+
+//
+// Fixed capacity move buffer that lives on the stack, so generating moves
+// at a search node never touches the heap. Each move has a score slot the
+// search can fill in to order moves.
+//
+class MoveList
+{
+public:
+    MoveList() : _size(0) { }
+
+    void add(const BitMove& move)
+    {
+        _scores[_size] = 0;
+        _moves[_size++] = move;
+    }
+    void emplace_back(int from, int to, int flags) { add(BitMove(from, to, flags)); }
+    void clear() { _size = 0; }
+
+    int size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    BitMove& operator[](int index) { return _moves[index]; }
+    const BitMove& operator[](int index) const { return _moves[index]; }
+    int& score(int index) { return _scores[index]; }
+    int score(int index) const { return _scores[index]; }
+
+    // Swap the best scored move at or after index into index, so a search
+    // can stop picking once it gets a cutoff without sorting the rest
+    void pickBest(int index)
+    {
+        int best = index;
+        for (int i = index + 1; i < _size; ++i) {
+            if (_scores[i] > _scores[best]) {
+                best = i;
+            }
+        }
+        if (best != index) {
+            std::swap(_moves[index], _moves[best]);
+            std::swap(_scores[index], _scores[best]);
+        }
+    }
+
+    BitMove* begin() { return _moves; }
+    BitMove* end() { return _moves + _size; }
+    const BitMove* begin() const { return _moves; }
+    const BitMove* end() const { return _moves + _size; }
+
+private:
+    BitMove _moves[maxMoves];
+    int _scores[maxMoves];
+    int _size;
+};
@@ -0,0 +1,292 @@
+#include "Nnue.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NNUE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NNUE_TARGET_AVX2
+#define NNUE_TARGET_SSE41
+#else
+#define NNUE_TARGET_AVX2 __attribute__((target("avx2")))
+#define NNUE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#endif
+#endif
+
+NnueNetwork nnue;
+
+namespace {
+    const char nnueMagic[8] = { 'C', 'H', 'E', 'S', 'S', 'N', 'N', '1' };
+    constexpr size_t headerSize = 64;
+    constexpr int activationMax = 127;
+    constexpr int outputQuantization = 64;
+
+    //
+    // The three hot loops, one set per instruction set
+    //
+    struct NnueKernels
+    {
+        void (*addRow)(int16_t* values, const int16_t* row);
+        void (*subtractRow)(int16_t* values, const int16_t* row);
+        // clipped activations of both halves dotted with the output weights
+        int32_t (*output)(const int16_t* us, const int16_t* them, const int8_t* weights);
+        const char* name;
+    };
+
+    void addRowScalar(int16_t* values, const int16_t* row)
+    {
+        for (int i = 0; i < nnueHidden; ++i) {
+            values[i] = static_cast<int16_t>(values[i] + row[i]);
+        }
+    }
+
+    void subtractRowScalar(int16_t* values, const int16_t* row)
+    {
+        for (int i = 0; i < nnueHidden; ++i) {
+            values[i] = static_cast<int16_t>(values[i] - row[i]);
+        }
+    }
+
+    int32_t outputScalar(const int16_t* us, const int16_t* them, const int8_t* weights)
+    {
+        int32_t sum = 0;
+        for (int i = 0; i < nnueHidden; ++i) {
+            sum += std::clamp<int>(us[i], 0, activationMax) * weights[i];
+            sum += std::clamp<int>(them[i], 0, activationMax) * weights[nnueHidden + i];
+        }
+        return sum;
+    }
+
+#ifdef NNUE_X86
+    NNUE_TARGET_SSE41 void addRowSse41(int16_t* values, const int16_t* row)
+    {
+        for (int i = 0; i < nnueHidden; i += 8) {
+            __m128i* target = reinterpret_cast<__m128i*>(values + i);
+            const __m128i weights = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            _mm_store_si128(target, _mm_add_epi16(_mm_load_si128(target), weights));
+        }
+    }
+
+    NNUE_TARGET_SSE41 void subtractRowSse41(int16_t* values, const int16_t* row)
+    {
+        for (int i = 0; i < nnueHidden; i += 8) {
+            __m128i* target = reinterpret_cast<__m128i*>(values + i);
+            const __m128i weights = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            _mm_store_si128(target, _mm_sub_epi16(_mm_load_si128(target), weights));
+        }
+    }
+
+    // clip sixteen sums to [0, 127], pack them to bytes and multiply-add
+    // against sixteen int8 weights into four int32 lanes
+    NNUE_TARGET_SSE41 __m128i dotSse41(const int16_t* values, const int8_t* weights)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ceiling = _mm_set1_epi16(activationMax);
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + 8));
+        low = _mm_min_epi16(_mm_max_epi16(low, zero), ceiling);
+        high = _mm_min_epi16(_mm_max_epi16(high, zero), ceiling);
+        const __m128i activations = _mm_packus_epi16(low, high);
+        const __m128i products = _mm_maddubs_epi16(activations, _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights)));
+        return _mm_madd_epi16(products, _mm_set1_epi16(1));
+    }
+
+    NNUE_TARGET_SSE41 int32_t outputSse41(const int16_t* us, const int16_t* them, const int8_t* weights)
+    {
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < nnueHidden; i += 16) {
+            sum = _mm_add_epi32(sum, dotSse41(us + i, weights + i));
+            sum = _mm_add_epi32(sum, dotSse41(them + i, weights + nnueHidden + i));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum);
+    }
+
+    NNUE_TARGET_AVX2 void addRowAvx2(int16_t* values, const int16_t* row)
+    {
+        for (int i = 0; i < nnueHidden; i += 16) {
+            __m256i* target = reinterpret_cast<__m256i*>(values + i);
+            const __m256i weights = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+            _mm256_store_si256(target, _mm256_add_epi16(_mm256_load_si256(target), weights));
+        }
+    }
+
+    NNUE_TARGET_AVX2 void subtractRowAvx2(int16_t* values, const int16_t* row)
+    {
+        for (int i = 0; i < nnueHidden; i += 16) {
+            __m256i* target = reinterpret_cast<__m256i*>(values + i);
+            const __m256i weights = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+            _mm256_store_si256(target, _mm256_sub_epi16(_mm256_load_si256(target), weights));
+        }
+    }
+
+    NNUE_TARGET_AVX2 __m256i dotAvx2(const int16_t* values, const int8_t* weights)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i ceiling = _mm256_set1_epi16(activationMax);
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + 16));
+        low = _mm256_min_epi16(_mm256_max_epi16(low, zero), ceiling);
+        high = _mm256_min_epi16(_mm256_max_epi16(high, zero), ceiling);
+        // packus works per 128-bit lane; the permute puts the bytes back in order
+        const __m256i activations = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+        const __m256i products = _mm256_maddubs_epi16(activations, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights)));
+        return _mm256_madd_epi16(products, _mm256_set1_epi16(1));
+    }
+
+    NNUE_TARGET_AVX2 int32_t outputAvx2(const int16_t* us, const int16_t* them, const int8_t* weights)
+    {
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < nnueHidden; i += 32) {
+            sum = _mm256_add_epi32(sum, dotAvx2(us + i, weights + i));
+            sum = _mm256_add_epi32(sum, dotAvx2(them + i, weights + nnueHidden + i));
+        }
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+        return _mm_cvtsi128_si32(half);
+    }
+
+    bool cpuHasAvx2()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        // the OS has to save the YMM registers too
+        const bool osxsave = (info[2] >> 27) & 1;
+        if (!osxsave || (_xgetbv(0) & 6) != 6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] >> 5) & 1;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    bool cpuHasSse41()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] >> 19) & 1;
+#else
+        return __builtin_cpu_supports("sse4.1");
+#endif
+    }
+#endif
+
+    NnueKernels selectKernels()
+    {
+#ifdef NNUE_X86
+        if (cpuHasAvx2()) {
+            return { addRowAvx2, subtractRowAvx2, outputAvx2, "avx2" };
+        }
+        if (cpuHasSse41()) {
+            return { addRowSse41, subtractRowSse41, outputSse41, "sse4.1" };
+        }
+#endif
+        return { addRowScalar, subtractRowScalar, outputScalar, "scalar" };
+    }
+
+    const NnueKernels kernels = selectKernels();
+
+    // row of first layer weights for a piece seen from one side; each side
+    // sees its own pieces first and the board from its own end
+    size_t featureIndex(int perspective, int piece, int square)
+    {
+        const int color = piece >> 3;
+        const int kind = (color == perspective ? 0 : 6) + (piece & 7) - 1;
+        const int relativeSquare = perspective == 0 ? square : square ^ 56;
+        return static_cast<size_t>(kind * 64 + relativeSquare) * nnueHidden;
+    }
+
+    template <typename T>
+    T readValue(const uint8_t* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+}
+
+bool NnueNetwork::load(const std::string& path)
+{
+    unload();
+
+    const size_t expectedSize = headerSize
+                              + nnueHidden * sizeof(int16_t)
+                              + static_cast<size_t>(nnueInputs) * nnueHidden * sizeof(int16_t)
+                              + 2 * nnueHidden * sizeof(int8_t)
+                              + sizeof(int32_t);
+    if (!_file.open(path)) {
+        return false;
+    }
+    const uint8_t* data = _file.data();
+    if (_file.size() != expectedSize || std::memcmp(data, nnueMagic, sizeof(nnueMagic)) != 0
+        || readValue<uint32_t>(data + 8) != nnueInputs || readValue<uint32_t>(data + 12) != nnueHidden) {
+        _file.close();
+        return false;
+    }
+
+    // the mapping is page aligned and every block a multiple of 64 bytes
+    // up to the output weights, so the int16 rows stay aligned
+    size_t offset = headerSize;
+    _outputScale = readValue<int32_t>(data + 16);
+    _featureBias = reinterpret_cast<const int16_t*>(data + offset);
+    offset += nnueHidden * sizeof(int16_t);
+    _featureWeights = reinterpret_cast<const int16_t*>(data + offset);
+    offset += static_cast<size_t>(nnueInputs) * nnueHidden * sizeof(int16_t);
+    _outputWeights = reinterpret_cast<const int8_t*>(data + offset);
+    offset += 2 * nnueHidden * sizeof(int8_t);
+    _outputBias = readValue<int32_t>(data + offset);
+    _enabled = true;
+    return true;
+}
+
+void NnueNetwork::unload()
+{
+    _file.close();
+    _featureBias = nullptr;
+    _featureWeights = nullptr;
+    _outputWeights = nullptr;
+    _outputBias = 0;
+    _outputScale = 0;
+    _enabled = false;
+}
+
+void NnueNetwork::resetAccumulator(NnueAccumulator& accumulator) const
+{
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        std::memcpy(accumulator.values[perspective], _featureBias, sizeof(accumulator.values[perspective]));
+    }
+}
+
+void NnueNetwork::addPiece(NnueAccumulator& accumulator, int piece, int square) const
+{
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        kernels.addRow(accumulator.values[perspective], _featureWeights + featureIndex(perspective, piece, square));
+    }
+}
+
+void NnueNetwork::removePiece(NnueAccumulator& accumulator, int piece, int square) const
+{
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        kernels.subtractRow(accumulator.values[perspective], _featureWeights + featureIndex(perspective, piece, square));
+    }
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, int sideToMove) const
+{
+    const int32_t output = kernels.output(accumulator.values[sideToMove], accumulator.values[sideToMove ^ 1], _outputWeights)
+                         + _outputBias;
+    return static_cast<int>(static_cast<int64_t>(output) * _outputScale / (activationMax * outputQuantization));
+}
+
+const char* NnueNetwork::kernelName()
+{
+    return kernels.name;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+
+//
+// Efficiently updatable neural network evaluation. One hidden layer, seen
+// from both sides: 768 inputs (12 piece kinds x 64 squares, mirrored for
+// Black) feed nnueHidden int16 sums per perspective. Position keeps those
+// sums in an NnueAccumulator and adds or subtracts one weight row per
+// piece that moves, so a move costs a few row updates instead of a full
+// layer. The output layer clips both halves to [0, 127], side to move
+// first, and dots them with int8 weights.
+//
+// Weight file layout, little endian, mapped rather than read:
+//   char     magic[8]        "CHESSNN1"
+//   uint32   inputs          768
+//   uint32   hidden          nnueHidden
+//   int32    outputScale     centipawns per unit of output
+//   padding to 64 bytes
+//   int16    featureBias[hidden]
+//   int16    featureWeights[inputs][hidden]
+//   int8     outputWeights[2 * hidden]
+//   int32    outputBias
+// Activations are quantized to 127 and output weights to 64, so the
+// score is (dot + outputBias) * outputScale / (127 * 64).
+//
+
+constexpr int nnueInputs = 768;
+constexpr int nnueHidden = 256;
+
+struct alignas(64) NnueAccumulator
+{
+    int16_t values[2][nnueHidden];   // [perspective]
+};
+
+class NnueNetwork
+{
+public:
+    // maps path and turns the network on; false leaves it unloaded
+    bool load(const std::string& path);
+    void unload();
+    bool isLoaded() const { return _featureWeights != nullptr; }
+
+    // Position only keeps accumulators while this is true. Change it, or
+    // load a network, only while no search is running.
+    bool isEnabled() const { return _enabled && isLoaded(); }
+    void setEnabled(bool enabled) { _enabled = enabled; }
+
+    void resetAccumulator(NnueAccumulator& accumulator) const;
+    void addPiece(NnueAccumulator& accumulator, int piece, int square) const;
+    void removePiece(NnueAccumulator& accumulator, int piece, int square) const;
+
+    // centipawns for the side to move
+    int evaluate(const NnueAccumulator& accumulator, int sideToMove) const;
+
+    // "avx2", "sse4.1" or "scalar", picked from CPUID at startup
+    static const char* kernelName();
+
+private:
+    MappedFile _file;
+    const int16_t* _featureBias = nullptr;
+    const int16_t* _featureWeights = nullptr;
+    const int8_t* _outputWeights = nullptr;
+    int32_t _outputBias = 0;
+    int32_t _outputScale = 0;
+    bool _enabled = false;
+};
+
+extern NnueNetwork nnue;
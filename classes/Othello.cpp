@@ -1,11 +1,5 @@
 #include "Othello.h"
-#include <iostream>
-
-// Define the 8 directions: N, NE, E, SE, S, SW, W, NW
-const int Othello::DIRECTIONS[8][2] = {
-    {0, -1}, {1, -1}, {1, 0}, {1, 1},
-    {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
-};
+#include "OthelloRules.h"
 
 Othello::Othello() : Game() {
     _grid = new Grid(8, 8);
@@ -62,7 +56,8 @@ bool Othello::actionForEmptyHolder(BitHolder &holder) {
     int y = square->getRow();
     Player* currentPlayer = getCurrentPlayer();
 
-    if (!isValidMove(x, y, currentPlayer)) return false;
+    uint64_t flips = othelloFlips(stateString(), y * 8 + x, currentPlayer->playerNumber());
+    if (!flips) return false;
 
     // Place the piece
     Bit* newPiece = createPiece(currentPlayer);
@@ -70,7 +65,7 @@ bool Othello::actionForEmptyHolder(BitHolder &holder) {
     holder.setBit(newPiece);
 
     // Flip all affected pieces
-    flipPieces(x, y, currentPlayer);
+    flipPieces(flips, currentPlayer);
     _consecutivePasses = 0;
 
     // Check if next player has moves
@@ -97,149 +92,40 @@ bool Othello::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
     return false; // Pieces cannot be moved in Othello
 }
 
-bool Othello::isValidMove(int x, int y, Player* player) const {
-    if (!_grid->isValid(x, y) || _grid->getSquare(x, y)->bit()) return false;
-
-    // Check if placing a piece here would flip at least one opponent piece
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player) > 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
-int Othello::checkDirection(int x, int y, int dx, int dy, Player* player) const {
-    int count = 0;
-    int nx = x + dx;
-    int ny = y + dy;
-
-    if (!_grid->isValid(nx, ny)) return 0;
-
-    Bit* firstPiece = _grid->getSquare(nx, ny)->bit();
-    if (!firstPiece || firstPiece->getOwner() == player) return 0;
-
-    // Count opponent pieces in this direction
-    while (_grid->isValid(nx, ny)) {
-        Bit* piece = _grid->getSquare(nx, ny)->bit();
-        if (!piece) return 0;
-        if (piece->getOwner() == player) return count;
-        count++;
-        nx += dx;
-        ny += dy;
-    }
-    return 0;
-}
-
-void Othello::flipPieces(int x, int y, Player* player) {
-    for (int i = 0; i < 8; i++) {
-        int count = checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player);
-        if (count > 0) {
-            flipInDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player, count);
-        }
-    }
-}
-
-void Othello::flipInDirection(int x, int y, int dx, int dy, Player* player, int count) {
-    int nx = x + dx;
-    int ny = y + dy;
-
-    for (int i = 0; i < count; i++) {
-        ChessSquare* square = _grid->getSquare(nx, ny);
-        if (square && square->bit()) {
+void Othello::flipPieces(uint64_t flips, Player* player) {
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        if ((flips >> (y * 8 + x)) & 1) {
             square->destroyBit();
             Bit* newPiece = createPiece(player);
             newPiece->setPosition(square->getPosition());
             square->setBit(newPiece);
         }
-        nx += dx;
-        ny += dy;
-    }
-}
-
-bool Othello::hasValidMove(Player* player) const {
-    bool hasMove = false;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (!hasMove && isValidMove(x, y, player)) {
-            hasMove = true;
-        }
     });
-    return hasMove;
 }
 
-std::vector<std::pair<int, int>> Othello::getValidMoves(Player* player) const {
-    std::vector<std::pair<int, int>> moves;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (isValidMove(x, y, player)) {
-            moves.push_back({x, y});
-        }
-    });
-    return moves;
+bool Othello::hasValidMove(Player* player) {
+    return othelloLegalMoves(stateString(), player->playerNumber()) != 0;
 }
 
 Player* Othello::checkForWinner() {
-    // Game ends when neither player can move
-    if (_consecutivePasses >= 2 ||
-        (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
-
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-
-        if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
-        if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
-    }
-
-    // Check if board is full
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
-        if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
-    }
-
+    // Game ends when neither player can move, which includes a full board
+    std::string state = stateString();
+    if (_consecutivePasses < 2 && !othelloGameOver(state)) return nullptr;
+
+    int blackCount, whiteCount;
+    othelloCountDiscs(state, blackCount, whiteCount);
+    if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
+    if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
     return nullptr;
 }
 
 bool Othello::checkForDraw() {
-    if (_consecutivePasses >= 2 ||
-        (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
-    }
-
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
+    std::string state = stateString();
+    if (_consecutivePasses < 2 && !othelloGameOver(state)) return false;
 
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
-    }
-    return false;
-}
-
-void Othello::countPieces(int &blackCount, int &whiteCount) const {
-    blackCount = 0;
-    whiteCount = 0;
-
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit* piece = square->bit();
-        if (piece) {
-            if (piece->getOwner() == getPlayerAt(BLACK_PLAYER)) {
-                blackCount++;
-            } else {
-                whiteCount++;
-            }
-        }
-    });
+    int blackCount, whiteCount;
+    othelloCountDiscs(state, blackCount, whiteCount);
+    return blackCount == whiteCount;
 }
 
 void Othello::stopGame() {
@@ -298,33 +184,14 @@ void Othello::setStateString(const std::string &s) {
 void Othello::updateAI() {
     if (!gameHasAI()) return;
 
-    Player* aiPlayer = getCurrentPlayer();
-    std::vector<std::pair<int, int>> validMoves = getValidMoves(aiPlayer);
-
-    if (validMoves.empty()) {
+    // Greedy: take the move that flips the most pieces
+    int bestSquare = othelloBestMove(stateString(), getCurrentPlayer()->playerNumber());
+    if (bestSquare < 0) {
         _consecutivePasses++;
         endTurn();
         return;
     }
-
-    // Find move that flips the most pieces
-    int bestX = -1, bestY = -1, maxFlips = 0;
-
-    for (const auto& move : validMoves) {
-        int x = move.first, y = move.second, totalFlips = 0;
-        for (int i = 0; i < 8; i++) {
-            totalFlips += checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], aiPlayer);
-        }
-        if (totalFlips > maxFlips) {
-            maxFlips = totalFlips;
-            bestX = x;
-            bestY = y;
-        }
-    }
-
-    if (bestX >= 0 && bestY >= 0) {
-        actionForEmptyHolder(*_grid->getSquare(bestX, bestY));
-    }
+    actionForEmptyHolder(*_grid->getSquare(bestSquare % 8, bestSquare / 8));
 }
 
 void Othello::getBoardPosition(BitHolder& holder, int &x, int &y) const {
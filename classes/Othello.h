@@ -1,6 +1,6 @@
 #pragma once
 #include "Game.h"
-#include <vector>
+#include <cstdint>
 
 // NOTE: This implementation assumes black.png and white.png exist in resources.
 // If not, you can use o.png and x.png, or any other suitable graphics.
@@ -33,18 +33,11 @@ private:
     static const int BLACK_PLAYER = 0;
     static const int WHITE_PLAYER = 1;
 
-    // Direction vectors for checking all 8 directions
-    static const int DIRECTIONS[8][2];
-
     // Helper methods
     Bit*        createPiece(Player* player);
-    bool        isValidMove(int x, int y, Player* player) const;
-    int         checkDirection(int x, int y, int dx, int dy, Player* player) const;
-    void        flipPieces(int x, int y, Player* player);
-    void        flipInDirection(int x, int y, int dx, int dy, Player* player, int count);
-    bool        hasValidMove(Player* player) const;
-    void        countPieces(int &blackCount, int &whiteCount) const;
-    std::vector<std::pair<int, int>> getValidMoves(Player* player) const;
+    // flip the discs in the mask over to player
+    void        flipPieces(uint64_t flips, Player* player);
+    bool        hasValidMove(Player* player);
     void        showValidMoves(Player* player);
     void        clearValidMoveIndicators();
 
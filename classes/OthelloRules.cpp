@@ -0,0 +1,96 @@
+#include "OthelloRules.h"
+
+namespace {
+    // N, NE, E, SE, S, SW, W, NW
+    const int directions[8][2] = {
+        {0, -1}, {1, -1}, {1, 0}, {1, 1},
+        {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
+    };
+
+    char playerDisc(int playerNumber) { return static_cast<char>('1' + playerNumber); }
+
+    // opponent discs bracketed between square and a disc of the player along (dx, dy)
+    uint64_t flipsInDirection(const std::string& state, int square, int dx, int dy, char disc)
+    {
+        uint64_t flips = 0;
+        int x = square % 8 + dx;
+        int y = square / 8 + dy;
+        while (x >= 0 && x < 8 && y >= 0 && y < 8) {
+            char cell = state[y * 8 + x];
+            if (cell == '0') {
+                return 0;
+            }
+            if (cell == disc) {
+                return flips;
+            }
+            flips |= 1ULL << (y * 8 + x);
+            x += dx;
+            y += dy;
+        }
+        return 0;
+    }
+
+    int popCount(uint64_t bits)
+    {
+        int count = 0;
+        for (; bits; bits &= bits - 1) {
+            ++count;
+        }
+        return count;
+    }
+}
+
+uint64_t othelloFlips(const std::string& state, int square, int playerNumber)
+{
+    if (state[square] != '0') {
+        return 0;
+    }
+    uint64_t flips = 0;
+    for (const int* direction : directions) {
+        flips |= flipsInDirection(state, square, direction[0], direction[1], playerDisc(playerNumber));
+    }
+    return flips;
+}
+
+uint64_t othelloLegalMoves(const std::string& state, int playerNumber)
+{
+    uint64_t moves = 0;
+    for (int square = 0; square < 64; ++square) {
+        if (othelloFlips(state, square, playerNumber)) {
+            moves |= 1ULL << square;
+        }
+    }
+    return moves;
+}
+
+int othelloBestMove(const std::string& state, int playerNumber)
+{
+    int bestSquare = -1;
+    int maxFlips = 0;
+    for (int square = 0; square < 64; ++square) {
+        int flips = popCount(othelloFlips(state, square, playerNumber));
+        if (flips > maxFlips) {
+            maxFlips = flips;
+            bestSquare = square;
+        }
+    }
+    return bestSquare;
+}
+
+void othelloCountDiscs(const std::string& state, int& blackCount, int& whiteCount)
+{
+    blackCount = 0;
+    whiteCount = 0;
+    for (char cell : state) {
+        if (cell == '1') {
+            ++blackCount;
+        } else if (cell == '2') {
+            ++whiteCount;
+        }
+    }
+}
+
+bool othelloGameOver(const std::string& state)
+{
+    return !othelloLegalMoves(state, 0) && !othelloLegalMoves(state, 1);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//
+// Othello rules on the 64 character state string used by
+// Othello::stateString(): row by row, '0' for an empty square, '1' for
+// black (player 0) and '2' for white (player 1). Square sets are
+// bitboards with bit y * 8 + x.
+//
+
+// empty squares where the player would flip at least one disc
+uint64_t othelloLegalMoves(const std::string& state, int playerNumber);
+// discs flipped by the player dropping a disc on square
+uint64_t othelloFlips(const std::string& state, int square, int playerNumber);
+// legal move that flips the most discs, or -1 if the player must pass
+int othelloBestMove(const std::string& state, int playerNumber);
+void othelloCountDiscs(const std::string& state, int& blackCount, int& whiteCount);
+// neither player can move
+bool othelloGameOver(const std::string& state);
@@ -0,0 +1,37 @@
+#include "PawnHash.h"
+#include "Evaluate.h"
+
+PawnHashTable::PawnHashTable(size_t entries)
+    : _entries(entries), _mask(entries - 1), _probes(0), _hits(0), _paramsVersion(0)
+{
+    clear();
+}
+
+void PawnHashTable::clear()
+{
+    // key zero is the empty formation, which scores nothing
+    for (PawnEntry& entry : _entries) {
+        entry = PawnEntry{ 0ULL, 0, 0 };
+    }
+    _paramsVersion = evalParamsVersion();
+}
+
+const PawnEntry& PawnHashTable::probe(const Position& position)
+{
+    if (_paramsVersion != evalParamsVersion()) {
+        clear();
+    }
+
+    const uint64_t key = position.pawnKey();
+    PawnEntry& entry = _entries[key & _mask];
+    ++_probes;
+    if (entry.key == key) {
+        ++_hits;
+        return entry;
+    }
+
+    int middlegame, endgame;
+    evaluatePawnStructure(position, middlegame, endgame);
+    entry = PawnEntry{ key, middlegame, endgame };
+    return entry;
+}
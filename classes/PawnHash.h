@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Position.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct PawnEntry
+{
+    uint64_t key;
+    int32_t middlegame;
+    int32_t endgame;
+};
+
+//
+// Cache of pawn structure scores keyed by Position::pawnKey(). Pawn
+// formations repeat across most of the tree, so nearly every evaluation is
+// a hit. Each search thread owns one, so there is no locking; an entry is
+// replaced whenever another formation maps to its slot.
+//
+class PawnHashTable
+{
+public:
+    explicit PawnHashTable(size_t entries = defaultEntries);
+
+    // a power of two, 2 MB of entries
+    static constexpr size_t defaultEntries = 1 << 17;
+
+    void clear();
+
+    // the formation's scores, evaluated and stored on a miss
+    const PawnEntry& probe(const Position& position);
+
+    // running totals, not reset by clear()
+    uint64_t probes() const { return _probes; }
+    uint64_t hits() const { return _hits; }
+
+private:
+    std::vector<PawnEntry> _entries;
+    uint64_t _mask;
+    uint64_t _probes;
+    uint64_t _hits;
+    // evalParamsVersion() the entries were scored with
+    int _paramsVersion;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+//
+// Per-square masks for pawn structure, built at compile time. The [2][64]
+// tables are indexed [color][square] with White first; "ahead" means
+// toward that colour's promotion rank.
+//
+
+using ColorSquareMasks = std::array<std::array<uint64_t, 64>, 2>;
+
+constexpr uint64_t fileMask(int file)
+{
+    return 0x0101010101010101ULL << file;
+}
+
+constexpr uint64_t rankMask(int rank)
+{
+    return (rank < 0 || rank > 7) ? 0ULL : 0xFFULL << (8 * rank);
+}
+
+constexpr uint64_t adjacentFilesMask(int file)
+{
+    return (file > 0 ? fileMask(file - 1) : 0ULL) | (file < 7 ? fileMask(file + 1) : 0ULL);
+}
+
+// every square on the ranks strictly ahead of rank
+constexpr uint64_t ranksAheadMask(int color, int rank)
+{
+    uint64_t mask = 0ULL;
+    for (int r = color == 0 ? rank + 1 : rank - 1; r >= 0 && r <= 7; r += color == 0 ? 1 : -1) {
+        mask |= rankMask(r);
+    }
+    return mask;
+}
+
+template <typename Build>
+constexpr ColorSquareMasks buildColorSquareMasks(Build build)
+{
+    ColorSquareMasks masks{};
+    for (int color = 0; color < 2; ++color) {
+        for (int square = 0; square < 64; ++square) {
+            masks[color][square] = build(color, square % 8, square / 8);
+        }
+    }
+    return masks;
+}
+
+// squares ahead on the pawn's own file; a friendly pawn there makes it doubled
+constexpr ColorSquareMasks ForwardFileMasks = buildColorSquareMasks([](int color, int file, int rank) {
+    return fileMask(file) & ranksAheadMask(color, rank);
+});
+
+// squares ahead on the pawn's and neighbouring files; no enemy pawn there means passed
+constexpr ColorSquareMasks PassedPawnMasks = buildColorSquareMasks([](int color, int file, int rank) {
+    return (fileMask(file) | adjacentFilesMask(file)) & ranksAheadMask(color, rank);
+});
+
+// neighbouring files level with or behind the pawn, where a friendly pawn
+// could still come up to defend it; none there and it may be backward
+constexpr ColorSquareMasks PawnSupportMasks = buildColorSquareMasks([](int color, int file, int rank) {
+    return adjacentFilesMask(file) & ~ranksAheadMask(color, rank);
+});
+
+// the king's file and its neighbours, one and two ranks ahead of the king
+constexpr ColorSquareMasks KingShieldMasks = buildColorSquareMasks([](int color, int file, int rank) {
+    const int step = color == 0 ? 1 : -1;
+    return (fileMask(file) | adjacentFilesMask(file)) & (rankMask(rank + step) | rankMask(rank + 2 * step));
+});
+
+static_assert(PassedPawnMasks[0][8 * 1 + 4] == 0x3838383838380000ULL, "e2 passed pawn mask");
+static_assert(PawnSupportMasks[1][8 * 6 + 0] == 0x0202000000000000ULL, "a7 support mask");
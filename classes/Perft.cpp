@@ -0,0 +1,57 @@
+#include "Perft.h"
+#include "MoveGen.h"
+
+uint64_t perft(Position& position, int depth, bool bulkCounting)
+{
+    if (depth <= 0) {
+        return 1;
+    }
+
+    MoveList moves;
+    generateLegalMoves(position, moves);
+    if (bulkCounting && depth == 1) {
+        return static_cast<uint64_t>(moves.size());
+    }
+
+    uint64_t nodes = 0;
+    for (const BitMove& move : moves) {
+        position.makeMove(move);
+        nodes += perft(position, depth - 1, bulkCounting);
+        position.unmakeMove(move);
+    }
+    return nodes;
+}
+
+std::vector<std::pair<BitMove, uint64_t>> perftDivide(Position& position, int depth, bool bulkCounting)
+{
+    std::vector<std::pair<BitMove, uint64_t>> counts;
+    if (depth <= 0) {
+        return counts;
+    }
+
+    MoveList moves;
+    generateLegalMoves(position, moves);
+    for (const BitMove& move : moves) {
+        position.makeMove(move);
+        counts.emplace_back(move, perft(position, depth - 1, bulkCounting));
+        position.unmakeMove(move);
+    }
+    return counts;
+}
+
+const std::vector<PerftCase>& perftSuite()
+{
+    // Counts from the Chess Programming Wiki perft results page. Between
+    // them they cover castling through and out of check, en passant
+    // discovered checks and every promotion piece.
+    static const std::vector<PerftCase> suite = {
+        { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609 },
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603 },
+        { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624 },
+        { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333 },
+        { "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 4, 422333 },
+        { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487 },
+        { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594 },
+    };
+    return suite;
+}
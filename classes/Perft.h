@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Position.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// Performance test: count the leaf nodes of the legal move tree to a fixed
+// depth. The totals are known for standard positions, so any mistake in
+// the move generator or make/unmake shows up as a wrong count.
+//
+// With bulk counting the last ply is not made; the size of the legal move
+// list is the number of leaves under it. Turning it off times makeMove and
+// unmakeMove as well as generation.
+//
+uint64_t perft(Position& position, int depth, bool bulkCounting = true);
+
+// leaf count under each root move, in generation order
+std::vector<std::pair<BitMove, uint64_t>> perftDivide(Position& position, int depth, bool bulkCounting = true);
+
+struct PerftCase
+{
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+// positions with published node counts
+const std::vector<PerftCase>& perftSuite();
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "Position.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+//
+// Opening book in the Polyglot .bin format: 16 byte big-endian entries of
+// key, move, weight and learn data, sorted by key. The file is mapped and
+// a position's entries are found by binary search, so a probe touches a
+// handful of pages however large the book is.
+//
+struct BookMove
+{
+    BitMove move;
+    int weight;
+};
+
+class PolyglotBook
+{
+public:
+    // false if the file is missing or not a whole number of entries
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return _file.isOpen(); }
+    size_t entryCount() const { return _file.size() / 16; }
+
+    // the book's moves for position that are legal in it, in file order
+    std::vector<BookMove> moves(const Position& position) const;
+    // one of them at random in proportion to its weight, a null move when
+    // the position is out of book
+    BitMove pickMove(const Position& position, std::mt19937_64& random) const;
+
+private:
+    MappedFile _file;
+};
+
+// Polyglot's own Zobrist key, which differs from Position::key()
+uint64_t polyglotKey(const Position& position);
@@ -0,0 +1,826 @@
+#include "Position.h"
+#include "MagicBitboards.h"
+#include "Zobrist.h"
+#include "Evaluate.h"
+#include "MoveGen.h"
+#include <algorithm>
+#include <charconv>
+
+namespace {
+    const char *pieceLetters = "0PNBRQK00pnbrqk";
+    constexpr int maxStateDepth = 256;
+    // the four fields writeFields() produces: 71 placement characters at
+    // most, then side, castling and en passant with their separators
+    constexpr int fieldsLength = 81;
+    // the longest int to_chars writes, sign included
+    constexpr int counterLength = 11;
+
+    // charToPiece without the table walk, for the FEN parser
+    int fenPiece(char c)
+    {
+        switch (c) {
+            case 'P': return makePiece(White, Pawn);
+            case 'N': return makePiece(White, Knight);
+            case 'B': return makePiece(White, Bishop);
+            case 'R': return makePiece(White, Rook);
+            case 'Q': return makePiece(White, Queen);
+            case 'K': return makePiece(White, King);
+            case 'p': return makePiece(Black, Pawn);
+            case 'n': return makePiece(Black, Knight);
+            case 'b': return makePiece(Black, Bishop);
+            case 'r': return makePiece(Black, Rook);
+            case 'q': return makePiece(Black, Queen);
+            case 'k': return makePiece(Black, King);
+            default: return 0;
+        }
+    }
+
+    // next space separated field at or after pos, leaving pos just past it
+    std::string_view nextField(std::string_view text, size_t& pos)
+    {
+        while (pos < text.size() && text[pos] == ' ') {
+            ++pos;
+        }
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != ' ') {
+            ++pos;
+        }
+        return text.substr(start, pos - start);
+    }
+
+    bool parseNumber(std::string_view field, int& value)
+    {
+        auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        return error == std::errc() && end == field.data() + field.size() && value >= 0;
+    }
+
+    // rights that survive a move touching each square; a king or rook
+    // leaving home, or a rook being captured there, clears its rights
+    struct CastlingMasks
+    {
+        int mask[64];
+
+        CastlingMasks()
+        {
+            for (int square = 0; square < 64; ++square) {
+                mask[square] = AllCastling;
+            }
+            mask[0] &= ~WhiteQueenSide;
+            mask[4] &= ~(WhiteKingSide | WhiteQueenSide);
+            mask[7] &= ~WhiteKingSide;
+            mask[56] &= ~BlackQueenSide;
+            mask[60] &= ~(BlackKingSide | BlackQueenSide);
+            mask[63] &= ~BlackKingSide;
+        }
+    };
+
+    const CastlingMasks castlingMasks;
+
+    // the square a pawn taken en passant actually stands on
+    int enPassantVictim(int to, ChessColor us) { return us == White ? to - 8 : to + 8; }
+
+    // rook squares for a castling move, given the king's destination
+    void castlingRookSquares(const BitMove& move, int& rookFrom, int& rookTo)
+    {
+        if (move.flags() == KingCastle) {
+            rookFrom = move.to() + 1;
+            rookTo = move.to() - 1;
+        } else {
+            rookFrom = move.to() - 2;
+            rookTo = move.to() + 1;
+        }
+    }
+
+    // An en passant square is only kept while a pawn of side attacks it.
+    // Otherwise a double push would leave a key no later position with the
+    // same pieces could match, and repetitions through it would be missed.
+    bool canTakeEnPassant(const Position& position, int square, ChessColor side)
+    {
+        const uint64_t pawns = position.pieces(side, Pawn);
+        const uint64_t takers = side == White ? WHITE_PAWN_ATTACKS(pawns) : BLACK_PAWN_ATTACKS(pawns);
+        return (takers & (1ULL << square)) != 0;
+    }
+
+    // a draw can be claimed once this many plies pass without a capture or pawn move
+    constexpr int fiftyMovePlies = 100;
+
+    // Every reversible move of a knight, bishop, rook, queen or king by the
+    // change it makes to the key, in a cuckoo hash of two slots per key.
+    // A key difference between the current position and an earlier one
+    // that is found here means a single move could bridge the two.
+    struct CuckooTable
+    {
+        static constexpr int size = 8192;
+        uint64_t keys[size] = {};
+        uint8_t from[size] = {};
+        uint8_t to[size] = {};
+
+        static int slot1(uint64_t key) { return static_cast<int>(key & (size - 1)); }
+        static int slot2(uint64_t key) { return static_cast<int>((key >> 16) & (size - 1)); }
+
+        CuckooTable()
+        {
+            const ChessPiece types[] = { Knight, Bishop, Rook, Queen, King };
+            for (int color = 0; color < 2; ++color) {
+                for (ChessPiece type : types) {
+                    const int piece = makePiece(static_cast<ChessColor>(color), type);
+                    for (int a = 0; a < 64; ++a) {
+                        uint64_t reach = type == Knight ? KnightAttacks[a]
+                                       : type == King ? KingAttacks[a]
+                                       : (type != Bishop ? ratt(a, 0ULL) : 0ULL) | (type != Rook ? batt(a, 0ULL) : 0ULL);
+                        for (int b = a + 1; b < 64; ++b) {
+                            if (reach & (1ULL << b)) {
+                                insert(zobrist.pieceSquare[piece][a] ^ zobrist.pieceSquare[piece][b] ^ zobrist.sideToMove,
+                                       static_cast<uint8_t>(a), static_cast<uint8_t>(b));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // evicts whatever holds the slot into its other one, until a slot is free
+        void insert(uint64_t key, uint8_t a, uint8_t b)
+        {
+            int slot = slot1(key);
+            while (true) {
+                std::swap(keys[slot], key);
+                std::swap(from[slot], a);
+                std::swap(to[slot], b);
+                if (key == 0) {
+                    return;
+                }
+                slot = slot == slot1(key) ? slot2(key) : slot1(key);
+            }
+        }
+
+        // the slot holding key, or -1
+        int find(uint64_t key) const
+        {
+            if (keys[slot1(key)] == key) return slot1(key);
+            if (keys[slot2(key)] == key) return slot2(key);
+            return -1;
+        }
+    };
+
+    // built on first use, as the keys come from another file's static
+    const CuckooTable& cuckooTable()
+    {
+        static const CuckooTable table;
+        return table;
+    }
+}
+
+char pieceToChar(int piece)
+{
+    return (piece > 0 && piece < 15) ? pieceLetters[piece] : '0';
+}
+
+int charToPiece(char c)
+{
+    if (c == '0') {
+        return 0;
+    }
+    for (int piece = 1; piece < 15; ++piece) {
+        if (pieceLetters[piece] == c) {
+            return piece;
+        }
+    }
+    return 0;
+}
+
+Position::Position()
+{
+    _states.reserve(maxStateDepth);
+    clear();
+}
+
+void Position::clear()
+{
+    for (int color = 0; color < 2; ++color) {
+        for (int type = 0; type < 7; ++type) {
+            _pieces[color][type] = 0ULL;
+        }
+    }
+    for (int square = 0; square < 64; ++square) {
+        _board[square] = 0;
+    }
+    _occupied = 0ULL;
+    _sideToMove = White;
+    _castlingRights = 0;
+    _enPassantSquare = -1;
+    _halfmoveClock = 0;
+    _fullmoveNumber = 1;
+    _pliesFromNull = 0;
+    _key = 0ULL;
+    _pawnKey = 0ULL;
+    _middlegameScore = 0;
+    _endgameScore = 0;
+    _gamePhase = 0;
+    _states.clear();
+    _accumulators.assign(1, NnueAccumulator{});
+    _restoringAccumulator = false;
+    if (nnue.isEnabled()) {
+        _accumulators.reserve(maxStateDepth + 1);
+        nnue.resetAccumulator(_accumulators.back());
+    }
+}
+
+void Position::setFromState(const std::string& state, ChessColor sideToMove)
+{
+    clear();
+    for (int square = 0; square < 64 && square < static_cast<int>(state.size()); ++square) {
+        int piece = charToPiece(state[square]);
+        if (piece) {
+            putPiece(square, piece);
+        }
+    }
+    _sideToMove = sideToMove;
+    if (_sideToMove == Black) {
+        _key ^= zobrist.sideToMove;
+    }
+}
+
+bool Position::parseFields(std::string_view text, size_t& pos)
+{
+    std::string_view placement = nextField(text, pos);
+    int rank = 7;
+    int file = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) {
+                return false;
+            }
+            --rank;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) {
+                return false;
+            }
+        } else {
+            int piece = fenPiece(c);
+            if (!piece || file > 7) {
+                return false;
+            }
+            putPiece(rank * 8 + file, piece);
+            ++file;
+        }
+    }
+    if (rank != 0 || file != 8) {
+        return false;
+    }
+
+    std::string_view side = nextField(text, pos);
+    if (side == "b") {
+        _sideToMove = Black;
+    } else if (side != "w") {
+        return false;
+    }
+
+    std::string_view castling = nextField(text, pos);
+    if (castling.empty()) {
+        return false;
+    }
+    if (castling != "-") {
+        for (char c : castling) {
+            switch (c) {
+                case 'K': _castlingRights |= WhiteKingSide; break;
+                case 'Q': _castlingRights |= WhiteQueenSide; break;
+                case 'k': _castlingRights |= BlackKingSide; break;
+                case 'q': _castlingRights |= BlackQueenSide; break;
+                default: return false;
+            }
+        }
+    }
+    // a right whose king or rook has left home can never be used
+    if (_board[4] != makePiece(White, King)) _castlingRights &= ~(WhiteKingSide | WhiteQueenSide);
+    if (_board[7] != makePiece(White, Rook)) _castlingRights &= ~WhiteKingSide;
+    if (_board[0] != makePiece(White, Rook)) _castlingRights &= ~WhiteQueenSide;
+    if (_board[60] != makePiece(Black, King)) _castlingRights &= ~(BlackKingSide | BlackQueenSide);
+    if (_board[63] != makePiece(Black, Rook)) _castlingRights &= ~BlackKingSide;
+    if (_board[56] != makePiece(Black, Rook)) _castlingRights &= ~BlackQueenSide;
+
+    std::string_view enPassant = nextField(text, pos);
+    if (enPassant.empty()) {
+        return false;
+    }
+    if (enPassant != "-") {
+        // the skipped square is on rank 6 when white is to move, rank 3 when black is
+        const char expectedRank = _sideToMove == White ? '6' : '3';
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] != expectedRank) {
+            return false;
+        }
+        const int square = (enPassant[1] - '1') * 8 + (enPassant[0] - 'a');
+        if (canTakeEnPassant(*this, square, _sideToMove)) {
+            _enPassantSquare = square;
+        }
+    }
+    return true;
+}
+
+bool Position::setFromFen(std::string_view fen)
+{
+    clear();
+    size_t pos = 0;
+    bool valid = parseFields(fen, pos);
+
+    std::string_view halfmove = nextField(fen, pos);
+    std::string_view fullmove = nextField(fen, pos);
+    if (valid && !halfmove.empty()) {
+        valid = parseNumber(halfmove, _halfmoveClock);
+    }
+    if (valid && !fullmove.empty()) {
+        valid = parseNumber(fullmove, _fullmoveNumber);
+    }
+    if (valid) {
+        valid = nextField(fen, pos).empty() && isPlayable();
+    }
+
+    if (!valid) {
+        clear();
+        return false;
+    }
+    _key = computeKey();
+    return true;
+}
+
+bool Position::setFromEpd(std::string_view epd, EpdOperations* operations)
+{
+    clear();
+    if (operations) {
+        operations->clear();
+    }
+    size_t pos = 0;
+    if (!parseFields(epd, pos) || !isPlayable()) {
+        clear();
+        return false;
+    }
+
+    // operations run to a semicolon that is not inside a quoted string
+    while (pos < epd.size()) {
+        while (pos < epd.size() && epd[pos] == ' ') {
+            ++pos;
+        }
+        size_t end = pos;
+        bool quoted = false;
+        while (end < epd.size() && (quoted || epd[end] != ';')) {
+            quoted ^= epd[end] == '"';
+            ++end;
+        }
+        size_t operandPos = pos;
+        std::string_view opcode = nextField(epd.substr(0, end), operandPos);
+        std::string_view operand = epd.substr(operandPos, end - operandPos);
+        while (!operand.empty() && operand.front() == ' ') operand.remove_prefix(1);
+        while (!operand.empty() && operand.back() == ' ') operand.remove_suffix(1);
+
+        if (!opcode.empty()) {
+            if (opcode == "hmvc" && !parseNumber(operand, _halfmoveClock)) {
+                clear();
+                return false;
+            }
+            if (opcode == "fmvn" && !parseNumber(operand, _fullmoveNumber)) {
+                clear();
+                return false;
+            }
+            if (operations) {
+                operations->emplace_back(std::string(opcode), std::string(operand));
+            }
+        }
+        pos = end + 1;
+    }
+
+    _key = computeKey();
+    return true;
+}
+
+bool Position::isPlayable() const
+{
+    if (countOnes(_pieces[White][King]) != 1 || countOnes(_pieces[Black][King]) != 1) {
+        return false;
+    }
+    return !isSquareAttacked(kingSquare(opposite(_sideToMove)), _sideToMove);
+}
+
+int Position::writeFields(char* out) const
+{
+    char* p = out;
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            int piece = _board[rank * 8 + file];
+            if (!piece) {
+                ++empty;
+                continue;
+            }
+            if (empty) {
+                *p++ = static_cast<char>('0' + empty);
+                empty = 0;
+            }
+            *p++ = pieceLetters[piece];
+        }
+        if (empty) {
+            *p++ = static_cast<char>('0' + empty);
+        }
+        if (rank) {
+            *p++ = '/';
+        }
+    }
+
+    *p++ = ' ';
+    *p++ = _sideToMove == White ? 'w' : 'b';
+    *p++ = ' ';
+    if (!_castlingRights) {
+        *p++ = '-';
+    }
+    if (_castlingRights & WhiteKingSide) *p++ = 'K';
+    if (_castlingRights & WhiteQueenSide) *p++ = 'Q';
+    if (_castlingRights & BlackKingSide) *p++ = 'k';
+    if (_castlingRights & BlackQueenSide) *p++ = 'q';
+    *p++ = ' ';
+    if (_enPassantSquare < 0) {
+        *p++ = '-';
+    } else {
+        *p++ = static_cast<char>('a' + _enPassantSquare % 8);
+        *p++ = static_cast<char>('1' + _enPassantSquare / 8);
+    }
+    return static_cast<int>(p - out);
+}
+
+std::string Position::fen() const
+{
+    char buffer[fieldsLength + 2 * (1 + counterLength)];
+    char* const limit = buffer + sizeof(buffer);
+    char* end = buffer + writeFields(buffer);
+    for (int counter : { _halfmoveClock, _fullmoveNumber }) {
+        if (end == limit) {
+            break;
+        }
+        *end++ = ' ';
+        auto [next, error] = std::to_chars(end, limit, counter);
+        if (error != std::errc()) {
+            break;
+        }
+        end = next;
+    }
+    return std::string(buffer, end);
+}
+
+std::string Position::epd(const EpdOperations& operations) const
+{
+    char buffer[fieldsLength];
+    std::string s(buffer, writeFields(buffer));
+    for (const auto& [opcode, operand] : operations) {
+        s += ' ';
+        s += opcode;
+        if (!operand.empty()) {
+            s += ' ';
+            s += operand;
+        }
+        s += ';';
+    }
+    return s;
+}
+
+std::string Position::stateString() const
+{
+    std::string s;
+    s.reserve(64);
+    for (int square = 0; square < 64; ++square) {
+        s += pieceToChar(_board[square]);
+    }
+    return s;
+}
+
+void Position::putPiece(int square, int piece)
+{
+    uint64_t mask = 1ULL << square;
+    ChessColor color = pieceColor(piece);
+    _pieces[color][pieceType(piece)] |= mask;
+    _pieces[color][NoPiece] |= mask;
+    _occupied |= mask;
+    _board[square] = static_cast<uint8_t>(piece);
+    _key ^= zobrist.pieceSquare[piece][square];
+    if (pieceType(piece) == Pawn) {
+        _pawnKey ^= zobrist.pieceSquare[piece][square];
+    }
+    _middlegameScore += evalTables.score[Middlegame][piece][square];
+    _endgameScore += evalTables.score[Endgame][piece][square];
+    _gamePhase += evalTables.phase[piece];
+    if (nnue.isEnabled() && !_restoringAccumulator) {
+        nnue.addPiece(_accumulators.back(), piece, square);
+    }
+}
+
+void Position::removePiece(int square)
+{
+    int piece = _board[square];
+    if (!piece) {
+        return;
+    }
+    uint64_t mask = ~(1ULL << square);
+    ChessColor color = pieceColor(piece);
+    _pieces[color][pieceType(piece)] &= mask;
+    _pieces[color][NoPiece] &= mask;
+    _occupied &= mask;
+    _board[square] = 0;
+    _key ^= zobrist.pieceSquare[piece][square];
+    if (pieceType(piece) == Pawn) {
+        _pawnKey ^= zobrist.pieceSquare[piece][square];
+    }
+    _middlegameScore -= evalTables.score[Middlegame][piece][square];
+    _endgameScore -= evalTables.score[Endgame][piece][square];
+    _gamePhase -= evalTables.phase[piece];
+    if (nnue.isEnabled() && !_restoringAccumulator) {
+        nnue.removePiece(_accumulators.back(), piece, square);
+    }
+}
+
+int Position::kingSquare(ChessColor color) const
+{
+    uint64_t king = _pieces[color][King];
+    return king ? getFirstBit(king) : -1;
+}
+
+uint64_t Position::computeKey() const
+{
+    uint64_t key = 0ULL;
+    BitboardElement(_occupied).forEachBit([&](int square) {
+        key ^= zobrist.pieceSquare[_board[square]][square];
+    });
+    if (_sideToMove == Black) {
+        key ^= zobrist.sideToMove;
+    }
+    key ^= zobrist.castling[_castlingRights];
+    if (_enPassantSquare >= 0) {
+        key ^= zobrist.enPassantFile[_enPassantSquare & 7];
+    }
+    return key;
+}
+
+uint64_t Position::computePawnKey() const
+{
+    uint64_t key = 0ULL;
+    BitboardElement(_pieces[White][Pawn] | _pieces[Black][Pawn]).forEachBit([&](int square) {
+        key ^= zobrist.pieceSquare[_board[square]][square];
+    });
+    return key;
+}
+
+void Position::computeEvalTerms(int& middlegame, int& endgame, int& phase) const
+{
+    middlegame = 0;
+    endgame = 0;
+    phase = 0;
+    BitboardElement(_occupied).forEachBit([&](int square) {
+        const int piece = _board[square];
+        middlegame += evalTables.score[Middlegame][piece][square];
+        endgame += evalTables.score[Endgame][piece][square];
+        phase += evalTables.phase[piece];
+    });
+}
+
+void Position::computeAccumulator(NnueAccumulator& accumulator) const
+{
+    nnue.resetAccumulator(accumulator);
+    BitboardElement(_occupied).forEachBit([&](int square) {
+        nnue.addPiece(accumulator, _board[square], square);
+    });
+}
+
+void Position::refreshEvalTerms()
+{
+    computeEvalTerms(_middlegameScore, _endgameScore, _gamePhase);
+    if (nnue.isEnabled()) {
+        computeAccumulator(_accumulators.back());
+    }
+}
+
+void Position::makeMove(const BitMove& move)
+{
+    const ChessColor us = _sideToMove;
+    const int from = move.from();
+    const int to = move.to();
+    const int captureSquare = move.isEnPassant() ? enPassantVictim(to, us) : to;
+
+    StateInfo state;
+    state.captured = _board[captureSquare];
+    state.castlingRights = _castlingRights;
+    state.enPassantSquare = _enPassantSquare;
+    state.halfmoveClock = _halfmoveClock;
+    state.pliesFromNull = _pliesFromNull;
+    state.key = _key;
+    _states.push_back(state);
+    if (nnue.isEnabled()) {
+        _accumulators.push_back(_accumulators.back());
+    }
+
+    ++_pliesFromNull;
+    int piece = _board[from];
+    if (pieceType(piece) == Pawn || state.captured) {
+        _halfmoveClock = 0;
+    } else {
+        ++_halfmoveClock;
+    }
+    if (us == Black) {
+        ++_fullmoveNumber;
+    }
+
+    _key ^= zobrist.castling[_castlingRights];
+    if (_enPassantSquare >= 0) {
+        _key ^= zobrist.enPassantFile[_enPassantSquare & 7];
+        _enPassantSquare = -1;
+    }
+
+    removePiece(captureSquare);
+    removePiece(from);
+    putPiece(to, move.isPromotion() ? makePiece(us, move.promotionPiece()) : piece);
+
+    if (move.isCastle()) {
+        int rookFrom, rookTo;
+        castlingRookSquares(move, rookFrom, rookTo);
+        int rook = _board[rookFrom];
+        removePiece(rookFrom);
+        putPiece(rookTo, rook);
+    } else if (move.flags() == DoublePawnPush && canTakeEnPassant(*this, (from + to) / 2, opposite(us))) {
+        _enPassantSquare = (from + to) / 2;
+        _key ^= zobrist.enPassantFile[_enPassantSquare & 7];
+    }
+
+    _castlingRights &= castlingMasks.mask[from] & castlingMasks.mask[to];
+    _key ^= zobrist.castling[_castlingRights];
+
+    _sideToMove = opposite(_sideToMove);
+    _key ^= zobrist.sideToMove;
+}
+
+void Position::unmakeMove(const BitMove& move)
+{
+    const StateInfo& state = _states.back();
+    _sideToMove = opposite(_sideToMove);
+    const ChessColor us = _sideToMove;
+    const int from = move.from();
+    const int to = move.to();
+    const bool popAccumulator = nnue.isEnabled() && _accumulators.size() > 1;
+    if (popAccumulator) {
+        _accumulators.pop_back();
+        _restoringAccumulator = true;
+    }
+
+    if (move.isCastle()) {
+        int rookFrom, rookTo;
+        castlingRookSquares(move, rookFrom, rookTo);
+        int rook = _board[rookTo];
+        removePiece(rookTo);
+        putPiece(rookFrom, rook);
+    }
+
+    int piece = move.isPromotion() ? makePiece(us, Pawn) : _board[to];
+    removePiece(to);
+    putPiece(from, piece);
+    if (state.captured) {
+        putPiece(move.isEnPassant() ? enPassantVictim(to, us) : to, state.captured);
+    }
+
+    _castlingRights = state.castlingRights;
+    _enPassantSquare = state.enPassantSquare;
+    _halfmoveClock = state.halfmoveClock;
+    _pliesFromNull = state.pliesFromNull;
+    _key = state.key;
+    _states.pop_back();
+    _restoringAccumulator = false;
+    if (us == Black) {
+        --_fullmoveNumber;
+    }
+}
+
+void Position::makeNullMove()
+{
+    StateInfo state;
+    state.captured = 0;
+    state.castlingRights = _castlingRights;
+    state.enPassantSquare = _enPassantSquare;
+    state.halfmoveClock = _halfmoveClock;
+    state.pliesFromNull = _pliesFromNull;
+    state.key = _key;
+    _states.push_back(state);
+    if (nnue.isEnabled()) {
+        _accumulators.push_back(_accumulators.back());
+    }
+
+    ++_halfmoveClock;
+    _pliesFromNull = 0;
+    if (_enPassantSquare >= 0) {
+        _key ^= zobrist.enPassantFile[_enPassantSquare & 7];
+        _enPassantSquare = -1;
+    }
+    _sideToMove = opposite(_sideToMove);
+    _key ^= zobrist.sideToMove;
+}
+
+void Position::unmakeNullMove()
+{
+    const StateInfo& state = _states.back();
+    _sideToMove = opposite(_sideToMove);
+    _enPassantSquare = state.enPassantSquare;
+    _halfmoveClock = state.halfmoveClock;
+    _pliesFromNull = state.pliesFromNull;
+    _key = state.key;
+    _states.pop_back();
+    if (nnue.isEnabled() && _accumulators.size() > 1) {
+        _accumulators.pop_back();
+    }
+}
+
+bool Position::hasNonPawnMaterial(ChessColor color) const
+{
+    return (_pieces[color][Knight] | _pieces[color][Bishop] | _pieces[color][Rook] | _pieces[color][Queen]) != 0ULL;
+}
+
+bool Position::isRepetition(int ply) const
+{
+    // the side to move alternates, so only every other earlier position
+    // can match, and the nearest possible one is four plies back
+    const int size = static_cast<int>(_states.size());
+    const int end = std::min({ _halfmoveClock, _pliesFromNull, size });
+    bool seenBeforeRoot = false;
+    for (int back = 4; back <= end; back += 2) {
+        if (_states[size - back].key != _key) {
+            continue;
+        }
+        if (back < ply || seenBeforeRoot) {
+            return true;
+        }
+        seenBeforeRoot = true;
+    }
+    return false;
+}
+
+bool Position::isDraw(int ply) const
+{
+    if (_halfmoveClock >= fiftyMovePlies) {
+        if (!inCheck()) {
+            return true;
+        }
+        MoveList moves;
+        generateLegalMoves(*this, moves);
+        return !moves.empty();
+    }
+    return isRepetition(ply);
+}
+
+bool Position::hasUpcomingRepetition(int ply) const
+{
+    // An odd number of plies back the other side was to move, so the key
+    // difference is one piece changing squares plus the side key. The
+    // earlier position has to be inside the search, the piece ours and
+    // its path clear.
+    const int size = static_cast<int>(_states.size());
+    const int end = std::min({ _halfmoveClock, _pliesFromNull, size, ply - 1 });
+    const CuckooTable& cuckoo = cuckooTable();
+    for (int back = 3; back <= end; back += 2) {
+        const int slot = cuckoo.find(_key ^ _states[size - back].key);
+        if (slot < 0) {
+            continue;
+        }
+        const int from = cuckoo.from[slot];
+        const int to = cuckoo.to[slot];
+        const int piece = _board[from] ? _board[from] : _board[to];
+        if (pieceColor(piece) == _sideToMove && !(betweenSquares(from, to) & _occupied)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t Position::attackersTo(int square, uint64_t occupied) const
+{
+    uint64_t target = 1ULL << square;
+    uint64_t rooksQueens = _pieces[White][Rook] | _pieces[White][Queen]
+                         | _pieces[Black][Rook] | _pieces[Black][Queen];
+    uint64_t bishopsQueens = _pieces[White][Bishop] | _pieces[White][Queen]
+                           | _pieces[Black][Bishop] | _pieces[Black][Queen];
+
+    // a white pawn attacks square if square attacks it like a black pawn would
+    return (BLACK_PAWN_ATTACKS(target) & _pieces[White][Pawn])
+         | (WHITE_PAWN_ATTACKS(target) & _pieces[Black][Pawn])
+         | (KnightAttacks[square] & (_pieces[White][Knight] | _pieces[Black][Knight]))
+         | (KingAttacks[square] & (_pieces[White][King] | _pieces[Black][King]))
+         | (getRookAttacks(square, occupied) & rooksQueens)
+         | (getBishopAttacks(square, occupied) & bishopsQueens);
+}
+
+bool Position::isSquareAttacked(int square, ChessColor byColor) const
+{
+    return (attackersTo(square, _occupied) & _pieces[byColor][NoPiece]) != 0;
+}
+
+bool Position::inCheck() const
+{
+    int king = kingSquare(_sideToMove);
+    if (king < 0) {
+        // Missing king is an invalid state; treat as check to block the move.
+        return true;
+    }
+    return isSquareAttacked(king, opposite(_sideToMove));
+}
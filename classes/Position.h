@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "Nnue.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum ChessColor
+{
+    White,
+    Black
+};
+
+// Mailbox piece codes keep the colour above the piece type, the same way
+// Bit game tags add 128 for black pieces. Zero is an empty square.
+inline int makePiece(ChessColor color, ChessPiece type) { return type | (color << 3); }
+inline ChessPiece pieceType(int piece) { return static_cast<ChessPiece>(piece & 7); }
+inline ChessColor pieceColor(int piece) { return static_cast<ChessColor>(piece >> 3); }
+inline ChessColor opposite(ChessColor color) { return static_cast<ChessColor>(color ^ 1); }
+
+// FEN style letter for a piece code, '0' for an empty square
+char pieceToChar(int piece);
+int charToPiece(char c);
+
+// EPD operations (bm, am, id, ...) in file order as opcode and operand
+// text, the operand as written minus the terminating semicolon
+using EpdOperations = std::vector<std::pair<std::string, std::string>>;
+
+enum CastlingRight
+{
+    WhiteKingSide = 1,
+    WhiteQueenSide = 2,
+    BlackKingSide = 4,
+    BlackQueenSide = 8,
+    AllCastling = 15
+};
+
+//
+// Everything makeMove() overwrites that unmakeMove() cannot recompute
+//
+struct StateInfo
+{
+    int captured;
+    int castlingRights;
+    int enPassantSquare;
+    int halfmoveClock;
+    int pliesFromNull;
+    uint64_t key;
+};
+
+//
+// Board representation used by the search. Twelve piece bitboards plus a
+// mailbox, updated incrementally by makeMove()/unmakeMove() so nothing has
+// to be rebuilt from the grid or a state string while searching.
+//
+class Position
+{
+public:
+    Position();
+
+    void clear();
+    // load the 64 character board produced by Chess::stateString()
+    void setFromState(const std::string& state, ChessColor sideToMove);
+    std::string stateString() const;
+
+    // FEN and EPD work straight on the bitboards. Loading returns false
+    // and leaves the position cleared if any field is malformed, a FEN has
+    // text after its counters, or the position can't be played: a king
+    // missing or doubled, or the side not to move in check. The move
+    // counters may be left off a FEN and default to 0 and 1.
+    bool setFromFen(std::string_view fen);
+    std::string fen() const;
+    // EPD is the first four FEN fields followed by operations; hmvc and
+    // fmvn operations set the move counters
+    bool setFromEpd(std::string_view epd, EpdOperations* operations = nullptr);
+    std::string epd(const EpdOperations& operations = {}) const;
+
+    void putPiece(int square, int piece);
+    void removePiece(int square);
+
+    int pieceOn(int square) const { return _board[square]; }
+    uint64_t pieces(ChessColor color, ChessPiece type) const { return _pieces[color][type]; }
+    uint64_t occupancy(ChessColor color) const { return _pieces[color][NoPiece]; }
+    uint64_t occupancy() const { return _occupied; }
+    ChessColor sideToMove() const { return _sideToMove; }
+    int castlingRights() const { return _castlingRights; }
+    // square a pawn skipped over on the last move, -1 if none or if no
+    // enemy pawn could take there
+    int enPassantSquare() const { return _enPassantSquare; }
+    // plies since the last capture or pawn move
+    int halfmoveClock() const { return _halfmoveClock; }
+    int fullmoveNumber() const { return _fullmoveNumber; }
+    int kingSquare(ChessColor color) const;
+    // Zobrist key, kept up to date by putPiece/removePiece and makeMove
+    uint64_t key() const { return _key; }
+    uint64_t computeKey() const;
+    // Zobrist key of the pawns alone, for the pawn structure cache
+    uint64_t pawnKey() const { return _pawnKey; }
+    uint64_t computePawnKey() const;
+    // Running material plus piece-square sums and game phase, kept up to
+    // date by putPiece/removePiece from evalTables, White positive
+    int middlegameScore() const { return _middlegameScore; }
+    int endgameScore() const { return _endgameScore; }
+    int gamePhase() const { return _gamePhase; }
+    // the same terms summed from scratch
+    void computeEvalTerms(int& middlegame, int& endgame, int& phase) const;
+    // recompute the running sums after the eval weights change, and the
+    // network accumulator when one is in use
+    void refreshEvalTerms();
+    // First layer sums of the network for this position, kept by
+    // putPiece/removePiece while nnue.isEnabled(); one per ply so
+    // unmakeMove just drops the top
+    const NnueAccumulator& accumulator() const { return _accumulators.back(); }
+    void computeAccumulator(NnueAccumulator& accumulator) const;
+
+    void makeMove(const BitMove& move);
+    void unmakeMove(const BitMove& move);
+    // pass the turn, for null-move pruning; never while in check
+    void makeNullMove();
+    void unmakeNullMove();
+    // any knight, bishop, rook or queen; without one, zugzwang is likely
+    bool hasNonPawnMaterial(ChessColor color) const;
+
+    // Draws by rule for a node ply plies below the search root, looking
+    // back through every move made on the position, the game's included.
+    // Inside the search a single earlier occurrence is already a draw, as
+    // the side that could repeat can always do so again; one from before
+    // the root has to come up for the third time. Only positions since the
+    // last capture, pawn move or null move can match, so the scan stops at
+    // the halfmove clock. The fifty-move rule gives way to a mate on the
+    // hundredth ply. A ply of 0 asks about the game itself.
+    bool isRepetition(int ply) const;
+    bool isDraw(int ply) const;
+    // some reversible move returns to a position seen since the root, so
+    // the side to move can draw whatever the rest of its moves are worth
+    bool hasUpcomingRepetition(int ply) const;
+
+    // every piece of either colour attacking square, given an occupancy
+    uint64_t attackersTo(int square, uint64_t occupied) const;
+    bool isSquareAttacked(int square, ChessColor byColor) const;
+    bool inCheck() const;
+
+private:
+    // the placement, side, castling and en passant fields shared by FEN
+    // and EPD, leaving pos after the last of them
+    bool parseFields(std::string_view text, size_t& pos);
+    // writes those four fields to out, returning the length
+    int writeFields(char* out) const;
+    // one king a side and the side that just moved not left in check, as
+    // move generation and the search take for granted
+    bool isPlayable() const;
+
+    // [color][type]; the NoPiece slot holds that colour's occupancy
+    uint64_t _pieces[2][7];
+    uint64_t _occupied;
+    uint8_t _board[64];
+    ChessColor _sideToMove;
+    int _castlingRights;
+    int _enPassantSquare;
+    int _halfmoveClock;
+    int _fullmoveNumber;
+    int _pliesFromNull;
+    uint64_t _key;
+    uint64_t _pawnKey;
+    int _middlegameScore;
+    int _endgameScore;
+    int _gamePhase;
+    std::vector<StateInfo> _states;
+    std::vector<NnueAccumulator> _accumulators;
+    // set while unmakeMove puts pieces back, as the parent accumulator
+    // is already correct
+    bool _restoringAccumulator;
+};
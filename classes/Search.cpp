@@ -0,0 +1,790 @@
+#include "Search.h"
+#include "Evaluate.h"
+#include "MoveGen.h"
+#include "See.h"
+#include "Tablebase.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+    // Ordering tiers: hash move, captures by MVV-LVA and queen promotions,
+    // killers, history, then underpromotions
+    constexpr int hashMoveScore = 1000000;
+    constexpr int captureScore = 100000;
+    constexpr int killerScore = 90000;
+    constexpr int historyMax = 80000;
+
+    // A capture has to be able to lift the score this close to alpha
+    constexpr int deltaMargin = 200;
+
+    // Aspiration windows start this wide around the last score and double
+    // on every fail; past the maximum the search goes full width
+    constexpr int aspirationMinDepth = 4;
+    constexpr int aspirationWindow = 25;
+    constexpr int aspirationMaxWindow = 800;
+
+    // Null move: pass and search shallower; if the opponent still can't
+    // get below beta, a real move would surely do better
+    constexpr int nullMoveMinDepth = 3;
+    constexpr int nullMoveReduction = 3;
+
+    // Reverse futility: the static eval beats beta by more than any
+    // plausible loss over the remaining plies
+    constexpr int reverseFutilityDepth = 6;
+    constexpr int reverseFutilityMargin = 90;   // per ply
+
+    // Futility: near the leaves a quiet move can't lift a hopeless static
+    // eval up to alpha
+    constexpr int futilityDepth = 3;
+    int futilityMargin(int depth) { return 80 + 100 * depth; }
+
+    // Late move pruning: near the leaves only the first few quiet moves,
+    // in ordering order, are worth searching at all
+    constexpr int lateMovePruningDepth = 3;
+    int lateMoveCount(int depth) { return 3 + depth * depth; }
+
+    // Late move reductions, by depth and move number, grow with the log of
+    // each so late moves at high depth lose the most
+    constexpr int reductionMinDepth = 3;
+    constexpr int reductionMinMove = 3;
+    struct ReductionTable
+    {
+        int reduction[maxSearchDepth][64];
+
+        ReductionTable()
+        {
+            for (int depth = 0; depth < maxSearchDepth; ++depth) {
+                for (int move = 0; move < 64; ++move) {
+                    reduction[depth][move] = (depth == 0 || move == 0)
+                        ? 0 : static_cast<int>(0.75 + std::log(depth) * std::log(move) / 2.25);
+                }
+            }
+        }
+    };
+
+    const ReductionTable reductionTable;
+
+    // type of the piece a capture removes; en passant takes a pawn off another square
+    ChessPiece capturedType(const Position& position, const BitMove& move)
+    {
+        return move.isEnPassant() ? Pawn : pieceType(position.pieceOn(move.to()));
+    }
+
+    bool isQuiet(const BitMove& move)
+    {
+        return !move.isCapture() && !move.isPromotion();
+    }
+
+    int staticScore(const Position& position, PawnHashTable& pawnTable)
+    {
+        const int playerColor = (position.sideToMove() == White) ? 1 : -1;
+        return evaluateBoard(position, &pawnTable) * playerColor;
+    }
+    // The table stores mate scores relative to the node instead of the
+    // root, so a mate found through a transposition keeps the right distance.
+    int scoreToTT(int score, int ply)
+    {
+        if (score >= mateBound) return score + ply;
+        if (score <= -mateBound) return score - ply;
+        return score;
+    }
+
+    int scoreFromTT(int score, int ply)
+    {
+        if (score >= mateBound) return score - ply;
+        if (score <= -mateBound) return score + ply;
+        return score;
+    }
+
+    // A tablebase result as a search score, the mate counted from the root
+    int tablebaseScore(const TablebaseResult& result, int ply)
+    {
+        if (result.wdl == TablebaseWin) return mateValue - ply - result.plies;
+        if (result.wdl == TablebaseLoss) return -mateValue + ply + result.plies;
+        return 0;
+    }
+}
+
+PruningEvents& PruningEvents::operator+=(const PruningEvents& other)
+{
+    nullMoveCutoffs += other.nullMoveCutoffs;
+    reductions += other.reductions;
+    reductionResearches += other.reductionResearches;
+    reverseFutilityCutoffs += other.reverseFutilityCutoffs;
+    futilityPrunes += other.futilityPrunes;
+    lateMovePrunes += other.lateMovePrunes;
+    return *this;
+}
+
+double SearchResult::branchingFactor() const
+{
+    return depth > 0 && nodes > 0 ? std::pow(static_cast<double>(nodes), 1.0 / depth) : 0.0;
+}
+
+Search::Search(TranspositionTable& transpositionTable)
+    : _transpositionTable(transpositionTable), _stopSignal(nullptr), _ponderSignal(nullptr), _threadId(0), _nodes(0), _cutoffs(0), _firstMoveCutoffs(0), _tablebaseHits(0), _stopped(false),
+      _completedDepth(0), _reportedNodes(0)
+{
+    for (int color = 0; color < 2; ++color) {
+        for (int from = 0; from < 64; ++from) {
+            for (int to = 0; to < 64; ++to) {
+                _history[color][from][to] = 0;
+            }
+        }
+    }
+}
+
+SearchResult Search::think(Position& position, const SearchLimits& limits)
+{
+    _limits = limits;
+    if (_limits.movetime > 0) {
+        _limits.softTime = _limits.movetime;
+        _limits.hardTime = _limits.movetime;
+    }
+    _startTime = std::chrono::steady_clock::now();
+    _clockStart = _startTime;
+    _pondering = _limits.ponder;
+    _nodes = 0;
+    _cutoffs = 0;
+    _firstMoveCutoffs = 0;
+    _tablebaseHits = 0;
+    _pruningEvents = PruningEvents();
+    _stopped = false;
+    resetProgress();
+    // the eval weights may have been reloaded since the position was set up
+    position.refreshEvalTerms();
+    const uint64_t pawnProbes = _pawnTable.probes();
+    const uint64_t pawnHits = _pawnTable.hits();
+
+    // Killers are position specific; history is only aged so it carries
+    // over from the previous move
+    for (int ply = 0; ply < maxPly; ++ply) {
+        _killers[ply][0] = BitMove();
+        _killers[ply][1] = BitMove();
+    }
+    for (int color = 0; color < 2; ++color) {
+        for (int from = 0; from < 64; ++from) {
+            for (int to = 0; to < 64; ++to) {
+                _history[color][from][to] /= 2;
+            }
+        }
+    }
+
+    SearchResult result;
+    MoveList rootMoves;
+    generateLegalMoves(position, rootMoves);
+    if (rootMoves.empty()) {
+        result.score = position.inCheck() ? -mateValue : 0;
+        return result;
+    }
+
+    TTEntry rootEntry;
+    scoreMoves(position, rootMoves, _transpositionTable.probe(position.key(), rootEntry) ? rootEntry.move : BitMove(), 0);
+    for (int i = 0; i < rootMoves.size(); ++i) {
+        rootMoves.pickBest(i);
+    }
+    result.bestMove = rootMoves[0];
+
+    const int multiPV = std::clamp(_limits.multiPV, 1, rootMoves.size());
+    const int maxDepth = _limits.depth > 0 ? std::min(_limits.depth, maxSearchDepth) : maxSearchDepth;
+    const bool solved = solveFromTablebases(position, rootMoves, multiPV, result);
+    for (int iteration = 1; !solved && iteration <= maxDepth; ++iteration) {
+        // odd helpers run one ply ahead so threads spread over two depths
+        // and fill the shared table with different subtrees
+        const int depth = std::min(iteration + (_threadId & 1), maxSearchDepth);
+
+        // MultiPV ranks one root move per pass, each pass searching only the
+        // moves not ranked yet, so pass n finds the n-th best line
+        std::vector<SearchLine> lines;
+        for (int pvIndex = 0; pvIndex < multiPV; ++pvIndex) {
+            // Aspiration: expect a score near the last iteration's and search
+            // a narrow window around it, widening whichever side it falls out of
+            const int expected = pvIndex < static_cast<int>(result.lines.size()) ? result.lines[pvIndex].score : result.score;
+            int window = aspirationWindow;
+            int alpha = negInfinite;
+            int beta = posInfinite;
+            if (depth >= aspirationMinDepth && std::abs(expected) < mateBound) {
+                alpha = expected - window;
+                beta = expected + window;
+            }
+            int score;
+            while (true) {
+                score = searchRoot(position, rootMoves, pvIndex, depth, alpha, beta);
+                if (_stopped || (score > alpha && score < beta)) {
+                    break;
+                }
+                window *= 2;
+                if (window > aspirationMaxWindow) {
+                    alpha = negInfinite;
+                    beta = posInfinite;
+                } else if (score <= alpha) {
+                    alpha = std::max(score - window, negInfinite);
+                } else {
+                    beta = std::min(score + window, posInfinite);
+                }
+            }
+            if (_stopped) {
+                break;
+            }
+
+            SearchLine line;
+            line.score = score;
+            line.pv.assign(_pvTable[0], _pvTable[0] + _pvLength[0]);
+            lines.push_back(std::move(line));
+        }
+        if (_stopped) {
+            break;
+        }
+
+        // a later pass can come back higher than an earlier one once the
+        // table has moved on, so rank the lines and the root moves together
+        std::stable_sort(lines.begin(), lines.end(), [](const SearchLine& a, const SearchLine& b) {
+            return a.score > b.score;
+        });
+        for (int pvIndex = 0; pvIndex < multiPV; ++pvIndex) {
+            rootMoves[pvIndex] = lines[pvIndex].pv[0];
+        }
+
+        result.bestMove = lines[0].pv[0];
+        result.score = lines[0].score;
+        result.depth = depth;
+        result.lines = lines;
+        _completedDepth.store(depth, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(_linesMutex);
+            _completedLines = std::move(lines);
+        }
+        if (_infoCallback) {
+            result.nodes = _nodes;
+            result.tablebaseHits = _tablebaseHits;
+            result.seconds = elapsedMilliseconds() / 1000.0;
+            _infoCallback(result);
+        }
+
+        // Nothing to choose between, or a forced mate is already found
+        if (rootMoves.size() == 1 || (multiPV == 1 && std::abs(result.score) >= mateBound)) {
+            break;
+        }
+        if (!pondering() && _limits.softTime > 0 && clockMilliseconds() >= _limits.softTime) {
+            break;
+        }
+    }
+
+    result.nodes = _nodes;
+    _reportedNodes.store(_nodes, std::memory_order_relaxed);
+    result.cutoffs = _cutoffs;
+    result.firstMoveCutoffs = _firstMoveCutoffs;
+    result.tablebaseHits = _tablebaseHits;
+    result.pruning = _pruningEvents;
+    result.pawnProbes = _pawnTable.probes() - pawnProbes;
+    result.pawnHits = _pawnTable.hits() - pawnHits;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _startTime).count();
+    return result;
+}
+
+bool Search::solveFromTablebases(Position& position, const MoveList& rootMoves, int multiPV, SearchResult& result)
+{
+    TablebaseResult rootResult;
+    if (!tablebases.probe(position, rootResult)) {
+        return false;
+    }
+
+    std::vector<SearchLine> lines;
+    for (const BitMove& move : rootMoves) {
+        position.makeMove(move);
+        TablebaseResult childResult;
+        const bool covered = tablebases.probe(position, childResult);
+        SearchLine line;
+        if (covered) {
+            _tablebaseHits++;
+            line.score = -tablebaseScore(childResult, 1);
+            line.pv.push_back(move);
+            followTablebases(position, line.pv);
+        }
+        position.unmakeMove(move);
+        if (!covered) {
+            return false;
+        }
+        lines.push_back(std::move(line));
+    }
+
+    std::stable_sort(lines.begin(), lines.end(), [](const SearchLine& a, const SearchLine& b) {
+        return a.score > b.score;
+    });
+    lines.resize(multiPV);
+    result.bestMove = lines[0].pv[0];
+    result.score = lines[0].score;
+    result.depth = 1;
+    result.lines = lines;
+    _completedDepth.store(result.depth, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(_linesMutex);
+        _completedLines = std::move(lines);
+    }
+    if (_infoCallback) {
+        result.tablebaseHits = _tablebaseHits;
+        result.seconds = elapsedMilliseconds() / 1000.0;
+        _infoCallback(result);
+    }
+    return true;
+}
+
+void Search::followTablebases(Position& position, std::vector<BitMove>& pv)
+{
+    TablebaseResult here;
+    if (static_cast<int>(pv.size()) >= maxPly || !tablebases.probe(position, here) || here.wdl == TablebaseDraw) {
+        return;
+    }
+
+    // the winner mates soonest, the loser holds out longest
+    MoveList moves;
+    generateLegalMoves(position, moves);
+    BitMove best;
+    int bestScore = negInfinite;
+    for (const BitMove& move : moves) {
+        position.makeMove(move);
+        TablebaseResult childResult;
+        if (tablebases.probe(position, childResult) && -tablebaseScore(childResult, 1) > bestScore) {
+            bestScore = -tablebaseScore(childResult, 1);
+            best = move;
+        }
+        position.unmakeMove(move);
+    }
+    if (best.isNull()) {
+        return;
+    }
+
+    pv.push_back(best);
+    position.makeMove(best);
+    followTablebases(position, pv);
+    position.unmakeMove(best);
+}
+
+int Search::searchRoot(Position& position, MoveList& rootMoves, int firstMove, int depth, int alpha, int beta)
+{
+    const int alphaOrig = alpha;
+    int bestVal = negInfinite;
+    int bestIndex = firstMove;
+
+    for (int i = firstMove; i < rootMoves.size(); ++i) {
+        position.makeMove(rootMoves[i]);
+        int score;
+        if (i == firstMove) {
+            score = -negamax(position, depth - 1, 1, -beta, -alpha);
+        } else {
+            score = -negamax(position, depth - 1, 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta && !_stopped) {
+                score = -negamax(position, depth - 1, 1, -beta, -alpha);
+            }
+        }
+        position.unmakeMove(rootMoves[i]);
+        if (_stopped) {
+            return bestVal;
+        }
+
+        if (score > bestVal) {
+            bestVal = score;
+            bestIndex = i;
+            updatePv(0, rootMoves[i]);
+        }
+        if (score > alpha) {
+            alpha = score;
+            if (alpha >= beta) {
+                break;
+            }
+        }
+    }
+
+    // The next iteration searches this iteration's best move first. After
+    // a fail low every move is only an upper bound, so the order stays.
+    if (bestVal > alphaOrig) {
+        std::rotate(rootMoves.begin() + firstMove, rootMoves.begin() + bestIndex, rootMoves.begin() + bestIndex + 1);
+    }
+    return bestVal;
+}
+
+int Search::negamax(Position& position, int depth, int ply, int alpha, int beta, bool allowNullMove)
+{
+    // A repetition or the fifty-move rule ends the line, even at the
+    // horizon. When a reversible move could repeat a position higher up
+    // the line, the side to move can hold the draw, so it is a floor.
+    if (position.isDraw(ply)) {
+        _pvLength[ply] = 0;
+        return 0;
+    }
+    if (alpha < 0 && position.hasUpcomingRepetition(ply)) {
+        alpha = 0;
+        if (alpha >= beta) {
+            _pvLength[ply] = 0;
+            return alpha;
+        }
+    }
+
+    if (depth <= 0) {
+        return quiescence(position, ply, alpha, beta);
+    }
+
+    _pvLength[ply] = 0;
+    _nodes++;
+    if (_limits.nodes > 0 && _nodes >= _limits.nodes) {
+        _stopped = true;
+    }
+    if ((_nodes & 1023) == 0) {
+        checkTime();
+    }
+    if (_stopped) {
+        return 0;
+    }
+
+    // the tables know the result exactly, whatever the depth left
+    TablebaseResult tablebaseResult;
+    if (tablebases.probe(position, tablebaseResult)) {
+        _tablebaseHits++;
+        return tablebaseScore(tablebaseResult, ply);
+    }
+
+    const int alphaOrig = alpha;
+    const uint64_t key = position.key();
+    BitMove hashMove;
+    TTEntry entry;
+    if (_transpositionTable.probe(key, entry)) {
+        hashMove = entry.move;
+        if (entry.depth >= depth) {
+            const int ttScore = scoreFromTT(entry.score, ply);
+            if (entry.bound == BoundExact) {
+                return ttScore;
+            }
+            if (entry.bound == BoundLower && ttScore >= beta) {
+                return ttScore;
+            }
+            if (entry.bound == BoundUpper && ttScore <= alpha) {
+                return ttScore;
+            }
+        }
+    }
+
+    const SearchPruning& pruning = _limits.pruning;
+    // nodes searched with an open window may end up on the principal
+    // variation, so they are never cut off on a static guess
+    const bool pvNode = beta - alpha > 1;
+    const bool inCheck = position.inCheck();
+    const int staticEval = inCheck ? negInfinite : staticScore(position, _pawnTable);
+
+    if (pruning.reverseFutility && !pvNode && !inCheck && depth <= reverseFutilityDepth && std::abs(beta) < mateBound
+        && staticEval - reverseFutilityMargin * depth >= beta) {
+        _pruningEvents.reverseFutilityCutoffs++;
+        return staticEval;
+    }
+
+    // Passing is only a safe lower bound while there are pieces to move:
+    // with just king and pawns the side to move is often in zugzwang
+    if (pruning.nullMove && !pvNode && allowNullMove && !inCheck && depth >= nullMoveMinDepth && staticEval >= beta
+        && std::abs(beta) < mateBound && position.hasNonPawnMaterial(position.sideToMove())) {
+        const int reduction = nullMoveReduction + depth / 6;
+        position.makeNullMove();
+        int score = -negamax(position, depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+        position.unmakeNullMove();
+        if (_stopped) {
+            return 0;
+        }
+        if (score >= beta) {
+            _pruningEvents.nullMoveCutoffs++;
+            // a mate found after passing proves nothing
+            return score >= mateBound ? beta : score;
+        }
+    }
+
+    MoveList newMoves;
+    generateLegalMoves(position, newMoves);
+    if (newMoves.empty()) {
+        if (inCheck) {
+            return -mateValue + ply;
+        }
+        return 0;
+    }
+
+    scoreMoves(position, newMoves, hashMove, ply);
+
+    int bestVal = negInfinite;
+    BitMove bestMove;
+    int quietMoves = 0;
+
+    for (int i = 0; i < newMoves.size(); ++i) {
+        newMoves.pickBest(i);
+        const BitMove move = newMoves[i];
+        const bool quiet = isQuiet(move);
+        position.makeMove(move);
+        const bool givesCheck = position.inCheck();
+
+        // Quiet moves that don't check may be skipped near the leaves, once
+        // some move has shown the node isn't lost
+        if (quiet && !inCheck && !givesCheck && bestVal > -mateBound) {
+            if (pruning.lateMovePruning && depth <= lateMovePruningDepth && quietMoves >= lateMoveCount(depth)) {
+                position.unmakeMove(move);
+                _pruningEvents.lateMovePrunes++;
+                continue;
+            }
+            if (pruning.futility && depth <= futilityDepth && staticEval + futilityMargin(depth) <= alpha) {
+                position.unmakeMove(move);
+                _pruningEvents.futilityPrunes++;
+                continue;
+            }
+        }
+        if (quiet) {
+            ++quietMoves;
+        }
+
+        // Principal variation search: the first move gets the full window
+        // and the rest only have to prove they are no better, with a null
+        // window, unless that proof fails. Late quiet moves try that proof
+        // at reduced depth first.
+        int reduction = 0;
+        if (pruning.lateMoveReductions && quiet && !inCheck && !givesCheck
+            && depth >= reductionMinDepth && i >= reductionMinMove) {
+            reduction = std::min(reductionTable.reduction[std::min(depth, maxSearchDepth - 1)][std::min(i, 63)], depth - 2);
+        }
+        // a search cut short by the stop signal leaves the score at alpha
+        int score = alpha;
+        if (i == 0) {
+            score = -negamax(position, depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            bool fullDepth = true;
+            if (reduction > 0) {
+                _pruningEvents.reductions++;
+                score = -negamax(position, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha);
+                if (_stopped) {
+                    position.unmakeMove(move);
+                    return 0;
+                }
+                fullDepth = score > alpha;
+                if (fullDepth) {
+                    _pruningEvents.reductionResearches++;
+                }
+            }
+            if (fullDepth && !_stopped) {
+                score = -negamax(position, depth - 1, ply + 1, -alpha - 1, -alpha);
+            }
+            if (!_stopped && score > alpha && score < beta) {
+                score = -negamax(position, depth - 1, ply + 1, -beta, -alpha);
+            }
+        }
+        position.unmakeMove(move);
+        if (_stopped) {
+            return 0;
+        }
+
+        if (score > bestVal) {
+            bestVal = score;
+            bestMove = move;
+            if (score > alpha) {
+                updatePv(ply, move);
+            }
+        }
+        alpha = std::max(alpha, bestVal);
+        if (alpha >= beta) {
+            _cutoffs++;
+            if (i == 0) {
+                _firstMoveCutoffs++;
+            }
+            if (isQuiet(move)) {
+                updateQuietStats(position, move, depth, ply);
+            }
+            break;
+        }
+    }
+
+    TTBound bound = BoundExact;
+    if (bestVal <= alphaOrig) {
+        bound = BoundUpper;
+        bestMove = BitMove();
+    } else if (bestVal >= beta) {
+        bound = BoundLower;
+    }
+    _transpositionTable.store(key, depth, scoreToTT(bestVal, ply), bound, bestMove);
+
+    return bestVal;
+}
+
+//
+// Resolve captures at the horizon so leaf scores are never taken in the
+// middle of an exchange. When in check every evasion is searched instead.
+//
+int Search::quiescence(Position& position, int ply, int alpha, int beta)
+{
+    // captures resolved here are left off the principal variation
+    if (ply < maxPly) {
+        _pvLength[ply] = 0;
+    }
+    _nodes++;
+    if (_limits.nodes > 0 && _nodes >= _limits.nodes) {
+        _stopped = true;
+    }
+    if ((_nodes & 1023) == 0) {
+        checkTime();
+    }
+    if (_stopped) {
+        return 0;
+    }
+
+    const bool inCheck = position.inCheck();
+    if (ply >= maxPly) {
+        return staticScore(position, _pawnTable);
+    }
+
+    int standPat = negInfinite;
+    int bestVal = negInfinite;
+    if (!inCheck) {
+        // the side to move can always decline to capture
+        standPat = staticScore(position, _pawnTable);
+        if (standPat >= beta) {
+            return standPat;
+        }
+        alpha = std::max(alpha, standPat);
+        bestVal = standPat;
+    }
+
+    MoveList moves;
+    if (inCheck) {
+        generateLegalMoves(position, moves);
+        if (moves.empty()) {
+            return -mateValue + ply;
+        }
+    } else {
+        generateLegalCaptures(position, moves);
+    }
+    scoreMoves(position, moves, BitMove(), maxPly);
+
+    for (int i = 0; i < moves.size(); ++i) {
+        moves.pickBest(i);
+        const BitMove move = moves[i];
+
+        if (!inCheck) {
+            // delta pruning: even winning the piece outright can't reach alpha
+            const int victim = capturedType(position, move);
+            if (standPat + seePieceValues[victim] + deltaMargin <= alpha) {
+                continue;
+            }
+            if (staticExchange(position, move) < 0) {
+                continue;
+            }
+        }
+
+        position.makeMove(move);
+        int score = -quiescence(position, ply + 1, -beta, -alpha);
+        position.unmakeMove(move);
+        if (_stopped) {
+            return 0;
+        }
+
+        if (score > bestVal) {
+            bestVal = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    return bestVal;
+}
+
+void Search::scoreMoves(const Position& position, MoveList& moves, const BitMove& hashMove, int ply) const
+{
+    const ChessColor us = position.sideToMove();
+    for (int i = 0; i < moves.size(); ++i) {
+        const BitMove& move = moves[i];
+        int score;
+        if (move == hashMove) {
+            score = hashMoveScore;
+        } else if (move.isCapture()) {
+            // most valuable victim first, least valuable attacker breaks ties
+            score = captureScore + capturedType(position, move) * 8 - pieceType(position.pieceOn(move.from()));
+        } else if (move.isPromotion()) {
+            score = move.promotionPiece() == Queen ? captureScore : -1;
+        } else if (ply < maxPly && move == _killers[ply][0]) {
+            score = killerScore;
+        } else if (ply < maxPly && move == _killers[ply][1]) {
+            score = killerScore - 1;
+        } else {
+            score = _history[us][move.from()][move.to()];
+        }
+        moves.score(i) = score;
+    }
+}
+
+void Search::updateQuietStats(const Position& position, const BitMove& move, int depth, int ply)
+{
+    if (ply < maxPly && !(move == _killers[ply][0])) {
+        _killers[ply][1] = _killers[ply][0];
+        _killers[ply][0] = move;
+    }
+
+    int& history = _history[position.sideToMove()][move.from()][move.to()];
+    history += depth * depth;
+    if (history >= historyMax) {
+        for (int color = 0; color < 2; ++color) {
+            for (int from = 0; from < 64; ++from) {
+                for (int to = 0; to < 64; ++to) {
+                    _history[color][from][to] /= 2;
+                }
+            }
+        }
+    }
+}
+
+void Search::updatePv(int ply, const BitMove& move)
+{
+    const int childLength = ply + 1 < maxPly ? _pvLength[ply + 1] : 0;
+    _pvTable[ply][0] = move;
+    std::copy(_pvTable[ply + 1], _pvTable[ply + 1] + childLength, _pvTable[ply] + 1);
+    _pvLength[ply] = childLength + 1;
+}
+
+void Search::resetProgress()
+{
+    _completedDepth.store(0, std::memory_order_relaxed);
+    _reportedNodes.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(_linesMutex);
+    _completedLines.clear();
+}
+
+std::vector<SearchLine> Search::completedLines() const
+{
+    std::lock_guard<std::mutex> lock(_linesMutex);
+    return _completedLines;
+}
+
+void Search::checkTime()
+{
+    _reportedNodes.store(_nodes, std::memory_order_relaxed);
+    if (_stopSignal && _stopSignal->load(std::memory_order_relaxed)) {
+        _stopped = true;
+    }
+    if (!pondering() && _limits.hardTime > 0 && clockMilliseconds() >= _limits.hardTime) {
+        _stopped = true;
+    }
+}
+
+bool Search::pondering()
+{
+    if (_pondering && !(_ponderSignal && _ponderSignal->load(std::memory_order_relaxed))) {
+        _pondering = false;
+        _clockStart = std::chrono::steady_clock::now();
+    }
+    return _pondering;
+}
+
+int Search::clockMilliseconds() const
+{
+    auto elapsed = std::chrono::steady_clock::now() - _clockStart;
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+int Search::elapsedMilliseconds() const
+{
+    auto elapsed = std::chrono::steady_clock::now() - _startTime;
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Position.h"
+#include "MoveList.h"
+#include "PawnHash.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+constexpr int maxSearchDepth = 64;
+constexpr int maxPly = 128;
+constexpr int posInfinite = 1000000;
+constexpr int negInfinite = -posInfinite;
+// Mate scores count plies from the root so shorter mates score higher
+constexpr int mateValue = posInfinite - 1000;
+constexpr int mateBound = mateValue - 500;
+
+//
+// Selective search techniques, each on by default. Turning one off makes
+// that part of the tree full width again, for testing what it is worth.
+//
+struct SearchPruning
+{
+    bool nullMove = true;
+    bool lateMoveReductions = true;
+    bool reverseFutility = true;
+    bool futility = true;
+    bool lateMovePruning = true;
+};
+
+//
+// How often each technique fired. Every count is one subtree the search
+// skipped, or for reductions one it searched shallower than full depth;
+// these are events, not nodes saved, as how big a skipped subtree would
+// have been is only known by searching it.
+//
+struct PruningEvents
+{
+    uint64_t nullMoveCutoffs = 0;
+    uint64_t reductions = 0;
+    uint64_t reductionResearches = 0;
+    uint64_t reverseFutilityCutoffs = 0;
+    uint64_t futilityPrunes = 0;
+    uint64_t lateMovePrunes = 0;
+
+    PruningEvents& operator+=(const PruningEvents& other);
+};
+
+//
+// What the search is allowed to spend on one move. Zero means no limit.
+// movetime fixes both time limits; otherwise a new iteration is only
+// started before softTime and a running one is abandoned at hardTime.
+// A ponder search runs with no time limit until the ponder signal clears,
+// and its clock starts from then.
+//
+struct SearchLimits
+{
+    int depth = 0;
+    uint64_t nodes = 0;
+    int movetime = 0;
+    int softTime = 0;
+    int hardTime = 0;
+    // root moves to rank with exact scores; the rest only need to be
+    // shown worse than the last of them
+    int multiPV = 1;
+    bool ponder = false;
+    SearchPruning pruning;
+};
+
+//
+// One ranked line of analysis: the principal variation from the root and
+// its score for the side to move
+//
+struct SearchLine
+{
+    int score = 0;
+    std::vector<BitMove> pv;
+};
+
+struct SearchResult
+{
+    BitMove bestMove;
+    int score = 0;
+    int depth = 0;          // last fully completed iteration
+    // best first, multiPV of them when there are that many legal moves;
+    // the first line's move and score are bestMove and score
+    std::vector<SearchLine> lines;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+    // beta cutoffs, and how many of them came from the first move searched
+    uint64_t cutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+    // pawn structure cache lookups, and how many found their formation
+    uint64_t pawnProbes = 0;
+    uint64_t pawnHits = 0;
+    // positions scored from the endgame tablebases instead of searched
+    uint64_t tablebaseHits = 0;
+    PruningEvents pruning;
+
+    double firstMoveCutoffRate() const { return cutoffs ? static_cast<double>(firstMoveCutoffs) / cutoffs : 0.0; }
+    double pawnHitRate() const { return pawnProbes ? static_cast<double>(pawnHits) / pawnProbes : 0.0; }
+    // average moves searched per ply, nodes^(1/depth)
+    double branchingFactor() const;
+};
+
+// Called on the searching thread after every completed iteration
+using SearchInfoCallback = std::function<void(const SearchResult&)>;
+
+//
+// Iterative deepening negamax over a Position. The transposition table is
+// owned by the caller so it survives from one move to the next.
+//
+class Search
+{
+public:
+    explicit Search(TranspositionTable& transpositionTable);
+
+    SearchResult think(Position& position, const SearchLimits& limits);
+
+    // Flag polled during the search; once it is set the search unwinds and
+    // returns the last completed iteration
+    void setStopSignal(const std::atomic<bool>* stopSignal) { _stopSignal = stopSignal; }
+    // Flag that stays set while a ponder search waits for the opponent;
+    // clearing it is the ponder hit that turns it into a timed search
+    void setPonderSignal(const std::atomic<bool>* ponderSignal) { _ponderSignal = ponderSignal; }
+    // Lazy SMP helpers use their id to search a different depth than the
+    // main thread (id 0) on alternate iterations
+    void setThreadId(int threadId) { _threadId = threadId; }
+    void setInfoCallback(SearchInfoCallback callback) { _infoCallback = std::move(callback); }
+
+    // Progress published for other threads while think() runs
+    int completedDepth() const { return _completedDepth.load(std::memory_order_relaxed); }
+    uint64_t nodesSearched() const { return _reportedNodes.load(std::memory_order_relaxed); }
+    // lines of the last completed iteration
+    std::vector<SearchLine> completedLines() const;
+    // zero the progress counters before a thread is started on a new search
+    void resetProgress();
+
+private:
+    // Searches rootMoves from firstMove on, which leaves the ones already
+    // ranked by MultiPV out, and moves the best of them to firstMove. Fail
+    // soft: a score at or below alpha, or at or above beta, is a bound.
+    int searchRoot(Position& position, MoveList& rootMoves, int firstMove, int depth, int alpha, int beta);
+    // With the root in the tablebases every move's result is known, so the
+    // lines are ranked and followed through the tables without a search.
+    // False if the root or one of its moves isn't covered.
+    bool solveFromTablebases(Position& position, const MoveList& rootMoves, int multiPV, SearchResult& result);
+    // extends pv from position along the tables' best moves to the mate
+    void followTablebases(Position& position, std::vector<BitMove>& pv);
+    // allowNullMove is false straight after a null move, so two passes
+    // never cancel out
+    int negamax(Position& position, int depth, int ply, int alpha, int beta, bool allowNullMove = true);
+    int quiescence(Position& position, int ply, int alpha, int beta);
+    void scoreMoves(const Position& position, MoveList& moves, const BitMove& hashMove, int ply) const;
+    void updateQuietStats(const Position& position, const BitMove& move, int depth, int ply);
+    // move followed by the variation below it becomes the line at ply
+    void updatePv(int ply, const BitMove& move);
+    void checkTime();
+    // true while pondering; notes the moment of a ponder hit
+    bool pondering();
+    int elapsedMilliseconds() const;
+    // time charged to the move, which starts at the ponder hit
+    int clockMilliseconds() const;
+
+    TranspositionTable& _transpositionTable;
+    const std::atomic<bool>* _stopSignal;
+    const std::atomic<bool>* _ponderSignal;
+    int _threadId;
+    SearchInfoCallback _infoCallback;
+    SearchLimits _limits;
+    std::chrono::steady_clock::time_point _startTime;
+    std::chrono::steady_clock::time_point _clockStart;
+    bool _pondering;
+    uint64_t _nodes;
+    uint64_t _cutoffs;
+    uint64_t _firstMoveCutoffs;
+    uint64_t _tablebaseHits;
+    PruningEvents _pruningEvents;
+    bool _stopped;
+    std::atomic<int> _completedDepth;
+    std::atomic<uint64_t> _reportedNodes;
+    mutable std::mutex _linesMutex;
+    std::vector<SearchLine> _completedLines;
+
+    // Triangular PV table: row ply holds the best line found from that
+    // ply, built by prefixing the child's row with the move that led there
+    BitMove _pvTable[maxPly][maxPly];
+    int _pvLength[maxPly];
+
+    // quiet moves that caused a cutoff at each ply, newest first
+    BitMove _killers[maxPly][2];
+    // butterfly history of quiet cutoffs by [color][from][to]
+    int _history[2][64][64];
+    // per thread, so evaluation never contends for it
+    PawnHashTable _pawnTable;
+};
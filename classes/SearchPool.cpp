@@ -0,0 +1,141 @@
+#include "SearchPool.h"
+#include <algorithm>
+
+namespace {
+    constexpr int maxThreads = 256;
+}
+
+SearchPool::SearchPool(TranspositionTable& transpositionTable)
+    : _transpositionTable(transpositionTable), _stop(false), _ponder(false), _searching(false)
+{
+    setThreadCount(1);
+}
+
+SearchPool::~SearchPool()
+{
+    stop();
+    wait();
+}
+
+void SearchPool::setThreadCount(int threads)
+{
+    threads = std::clamp(threads, 1, maxThreads);
+    while (static_cast<int>(_searches.size()) > threads) {
+        _searches.pop_back();
+    }
+    while (static_cast<int>(_searches.size()) < threads) {
+        auto search = std::make_unique<Search>(_transpositionTable);
+        search->setThreadId(static_cast<int>(_searches.size()));
+        search->setStopSignal(&_stop);
+        search->setPonderSignal(&_ponder);
+        _searches.push_back(std::move(search));
+    }
+}
+
+void SearchPool::setInfoCallback(SearchInfoCallback callback)
+{
+    if (!callback) {
+        _searches[0]->setInfoCallback(nullptr);
+        return;
+    }
+    _searches[0]->setInfoCallback([this, callback = std::move(callback)](const SearchResult& result) {
+        SearchResult total = result;
+        for (size_t i = 1; i < _searches.size(); ++i) {
+            total.nodes += _searches[i]->nodesSearched();
+        }
+        callback(total);
+    });
+}
+
+SearchResult SearchPool::think(const Position& position, const SearchLimits& limits)
+{
+    wait();
+    _stop.store(false);
+    _ponder.store(limits.ponder);
+    return run(position, limits);
+}
+
+void SearchPool::start(const Position& position, const SearchLimits& limits)
+{
+    wait();
+    // cleared here rather than on the worker so a stop() that arrives
+    // before the worker gets going is not lost, nor an early ponder hit
+    _stop.store(false);
+    _ponder.store(limits.ponder);
+    _searching.store(true, std::memory_order_release);
+    _worker = std::thread([this, position, limits]() {
+        _result = run(position, limits);
+        _searching.store(false, std::memory_order_release);
+    });
+}
+
+void SearchPool::stop()
+{
+    _stop.store(true);
+}
+
+void SearchPool::ponderHit()
+{
+    _ponder.store(false);
+}
+
+SearchResult SearchPool::wait()
+{
+    if (_worker.joinable()) {
+        _worker.join();
+    }
+    return _result;
+}
+
+SearchProgress SearchPool::progress() const
+{
+    SearchProgress progress;
+    progress.depth = _searches[0]->completedDepth();
+    progress.lines = _searches[0]->completedLines();
+    for (const auto& search : _searches) {
+        progress.nodes += search->nodesSearched();
+    }
+    return progress;
+}
+
+SearchResult SearchPool::run(const Position& position, const SearchLimits& limits)
+{
+    // helpers are bounded only by depth, as thread 0 decides when to
+    // stop; they prune the same way but only ever rank one line
+    SearchLimits helperLimits;
+    helperLimits.depth = limits.depth;
+    helperLimits.pruning = limits.pruning;
+
+    // so progress() and the info callback never see the last search's counts
+    for (auto& search : _searches) {
+        search->resetProgress();
+    }
+
+    std::vector<std::thread> helpers;
+    std::vector<SearchResult> helperResults(_searches.size());
+    for (size_t i = 1; i < _searches.size(); ++i) {
+        Search* search = _searches[i].get();
+        helpers.emplace_back([search, helperPosition = position, helperLimits, &helperResults, i]() mutable {
+            helperResults[i] = search->think(helperPosition, helperLimits);
+        });
+    }
+
+    Position mainPosition = position;
+    SearchResult result = _searches[0]->think(mainPosition, limits);
+
+    _stop.store(true);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    for (size_t i = 1; i < helperResults.size(); ++i) {
+        result.nodes += helperResults[i].nodes;
+        result.cutoffs += helperResults[i].cutoffs;
+        result.firstMoveCutoffs += helperResults[i].firstMoveCutoffs;
+        result.pawnProbes += helperResults[i].pawnProbes;
+        result.pawnHits += helperResults[i].pawnHits;
+        result.tablebaseHits += helperResults[i].tablebaseHits;
+        result.pruning += helperResults[i].pruning;
+    }
+    return result;
+}
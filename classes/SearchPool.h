@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Search.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct SearchProgress
+{
+    int depth = 0;          // deepest iteration thread 0 has completed
+    uint64_t nodes = 0;     // summed over all threads
+    std::vector<SearchLine> lines;  // from thread 0's last completed iteration
+};
+
+//
+// Lazy SMP: every thread runs the same iterative deepening search on its
+// own copy of the position, and they cooperate only through the shared
+// transposition table. Thread 0 owns the limits; when it finishes the
+// helpers are told to stop and its result is used.
+//
+// think() blocks the caller. start() runs the same search on a background
+// worker so a UI or console loop keeps running; poll isSearching(), call
+// stop() to cut it short, and collect the move with wait().
+//
+// A search started with limits.ponder runs untimed on the position after
+// the reply it expects. ponderHit() says that reply was played: the search
+// goes on, now under its time limits. On any other reply stop() it; the
+// table it filled still helps the real search.
+//
+class SearchPool
+{
+public:
+    explicit SearchPool(TranspositionTable& transpositionTable);
+    ~SearchPool();
+
+    // must not be called while a search is running
+    void setThreadCount(int threads);
+    int threadCount() const { return static_cast<int>(_searches.size()); }
+    // reports thread 0's iterations with node counts summed over all threads
+    void setInfoCallback(SearchInfoCallback callback);
+
+    SearchResult think(const Position& position, const SearchLimits& limits);
+
+    void start(const Position& position, const SearchLimits& limits);
+    void stop();
+    void ponderHit();
+    bool isSearching() const { return _searching.load(std::memory_order_acquire); }
+    SearchResult wait();
+    SearchProgress progress() const;
+
+private:
+    SearchResult run(const Position& position, const SearchLimits& limits);
+
+    TranspositionTable& _transpositionTable;
+    std::vector<std::unique_ptr<Search>> _searches;
+    std::atomic<bool> _stop;
+    std::atomic<bool> _ponder;
+    std::atomic<bool> _searching;
+    std::thread _worker;
+    SearchResult _result;
+};
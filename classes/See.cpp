@@ -0,0 +1,72 @@
+#include "See.h"
+#include "MagicBitboards.h"
+#include <algorithm>
+
+namespace {
+    // least valuable piece of color among attackers, or NoPiece
+    ChessPiece leastValuableAttacker(const Position& position, uint64_t attackers, ChessColor color, uint64_t& fromSet)
+    {
+        for (int type = Pawn; type <= King; ++type) {
+            uint64_t candidates = attackers & position.pieces(color, static_cast<ChessPiece>(type));
+            if (candidates) {
+                fromSet = candidates & (0ULL - candidates);
+                return static_cast<ChessPiece>(type);
+            }
+        }
+        fromSet = 0ULL;
+        return NoPiece;
+    }
+}
+
+int staticExchange(const Position& position, const BitMove& move)
+{
+    const int to = move.to();
+    const uint64_t bishopsQueens = position.pieces(White, Bishop) | position.pieces(White, Queen)
+                                 | position.pieces(Black, Bishop) | position.pieces(Black, Queen);
+    const uint64_t rooksQueens = position.pieces(White, Rook) | position.pieces(White, Queen)
+                               | position.pieces(Black, Rook) | position.pieces(Black, Queen);
+
+    int gain[32];
+    int depth = 0;
+    uint64_t occupied = position.occupancy();
+    uint64_t attackers = position.attackersTo(to, occupied);
+    uint64_t fromSet = 1ULL << move.from();
+    ChessPiece attacker = pieceType(position.pieceOn(move.from()));
+    ChessColor side = position.sideToMove();
+
+    gain[0] = seePieceValues[pieceType(position.pieceOn(to))];
+    if (move.isEnPassant()) {
+        // the captured pawn is not on to; take it off the board up front
+        const int victim = side == White ? to - 8 : to + 8;
+        occupied ^= 1ULL << victim;
+        attackers = position.attackersTo(to, occupied) & occupied;
+        gain[0] = seePieceValues[Pawn];
+    }
+    while (true) {
+        ++depth;
+        // what the next capture on to would win if this attacker is taken
+        gain[depth] = seePieceValues[attacker] - gain[depth - 1];
+        if (std::max(-gain[depth - 1], gain[depth]) < 0 || depth == 31) {
+            break;
+        }
+
+        // remove the attacker and uncover any slider x-raying through it
+        occupied ^= fromSet;
+        attackers ^= fromSet;
+        attackers |= (getBishopAttacks(to, occupied) & bishopsQueens)
+                   | (getRookAttacks(to, occupied) & rooksQueens);
+        attackers &= occupied;
+
+        side = opposite(side);
+        attacker = leastValuableAttacker(position, attackers, side, fromSet);
+        if (attacker == NoPiece) {
+            break;
+        }
+    }
+
+    // each side may stop recapturing when continuing would lose material
+    while (--depth) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    }
+    return gain[0];
+}
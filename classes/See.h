@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Position.h"
+
+// Piece values the exchange evaluator and quiescence pruning work in
+constexpr int seePieceValues[7] = { 0, 100, 320, 330, 500, 900, 20000 };
+
+// Material the side to move wins (or loses, if negative) when move starts
+// a sequence of captures on its destination and both sides keep
+// recapturing with their least valuable attacker while it pays.
+int staticExchange(const Position& position, const BitMove& move);
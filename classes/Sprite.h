@@ -1,5 +1,6 @@
 #pragma once
 #include "Entity.h"
+#include <cstdint>
 #include "../imgui/imgui.h"
 
 class Sprite : public Entity
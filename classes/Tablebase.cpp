@@ -0,0 +1,323 @@
+#include "Tablebase.h"
+#include "MagicBitboards.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+
+Tablebases tablebases;
+
+namespace {
+    const char tableMagic[8] = { 'C', 'H', 'E', 'S', 'S', 'T', 'B', '1' };
+    const char* tableExtension = ".tb";
+    constexpr uint8_t invalidEntry = 255;
+
+    // A side's non-king pieces as a base 3 number, one digit per type, so
+    // every ending has its own slot in a flat lookup table
+    constexpr int materialCodes = 243;
+    const int typeCode[7] = { 0, 1, 3, 9, 27, 81, 0 };
+
+    int materialCode(const int* pieces, int count, ChessColor color)
+    {
+        int code = 0;
+        for (int i = 0; i < count; ++i) {
+            if (pieceColor(pieces[i]) == color) {
+                code += typeCode[pieceType(pieces[i])];
+            }
+        }
+        return code;
+    }
+
+    // white king squares of the pawnless index: the a1-d1-d4 triangle
+    const int triangleSquares[10] = { 0, 1, 2, 3, 9, 10, 11, 18, 19, 27 };
+    const std::array<int, 64> triangleIndex = []() {
+        std::array<int, 64> index;
+        index.fill(-1);
+        for (int i = 0; i < 10; ++i) {
+            index[triangleSquares[i]] = i;
+        }
+        return index;
+    }();
+
+    // flip is xor'ed into the square (7 mirrors the files, 56 the ranks),
+    // then diagonal swaps file and rank
+    int foldSquare(int square, int flip, bool diagonal)
+    {
+        square ^= flip;
+        return diagonal ? ((square & 7) << 3) | (square >> 3) : square;
+    }
+
+    // Q R B N P, the order pieces are listed in a table's name
+    const char pieceLetters[7] = { '?', 'P', 'N', 'B', 'R', 'Q', 'K' };
+
+    bool strongerOrEqual(const std::vector<ChessPiece>& a, const std::vector<ChessPiece>& b)
+    {
+        if (a.size() != b.size()) {
+            return a.size() > b.size();
+        }
+        return !std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    TablebaseResult decodeEntry(uint8_t entry)
+    {
+        TablebaseResult result;
+        if (entry != 0) {
+            result.plies = entry - 1;
+            result.wdl = (result.plies & 1) ? TablebaseWin : TablebaseLoss;
+        }
+        return result;
+    }
+}
+
+TablebaseMaterial TablebaseMaterial::fromPieces(std::vector<ChessPiece> white, std::vector<ChessPiece> black)
+{
+    std::sort(white.begin(), white.end(), std::greater<ChessPiece>());
+    std::sort(black.begin(), black.end(), std::greater<ChessPiece>());
+    if (!strongerOrEqual(white, black)) {
+        std::swap(white, black);
+    }
+
+    TablebaseMaterial material;
+    for (ChessPiece type : white) {
+        material.pieces[material.count++] = makePiece(White, type);
+    }
+    for (ChessPiece type : black) {
+        material.pieces[material.count++] = makePiece(Black, type);
+    }
+    return material;
+}
+
+bool TablebaseMaterial::fromName(const std::string& name, TablebaseMaterial& material)
+{
+    const size_t versus = name.find("vK");
+    if (name.size() < 3 || name[0] != 'K' || versus == std::string::npos
+        || name.size() - 3 > static_cast<size_t>(tablebaseMaxPieces - 2)) {
+        return false;
+    }
+
+    std::vector<ChessPiece> sides[2];
+    for (size_t i = 1; i < name.size(); ++i) {
+        if (i == versus || i == versus + 1) {
+            continue;
+        }
+        const char* letter = std::find(pieceLetters + 1, pieceLetters + 6, name[i]);
+        if (letter == pieceLetters + 6) {
+            return false;
+        }
+        sides[i > versus].push_back(static_cast<ChessPiece>(letter - pieceLetters));
+    }
+    if (sides[0].empty() && sides[1].empty()) {
+        return false;
+    }
+
+    // only the canonical spelling, so each ending has one file
+    material = fromPieces(sides[0], sides[1]);
+    return material.name() == name;
+}
+
+std::string TablebaseMaterial::name() const
+{
+    std::string name = "K";
+    for (int i = 2; i < count; ++i) {
+        if (pieceColor(pieces[i]) == White) {
+            name += pieceLetters[pieceType(pieces[i])];
+        }
+    }
+    name += "vK";
+    for (int i = 2; i < count; ++i) {
+        if (pieceColor(pieces[i]) == Black) {
+            name += pieceLetters[pieceType(pieces[i])];
+        }
+    }
+    return name;
+}
+
+bool TablebaseMaterial::hasPawns() const
+{
+    for (int i = 2; i < count; ++i) {
+        if (pieceType(pieces[i]) == Pawn) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t TablebaseMaterial::size() const
+{
+    uint64_t size = hasPawns() ? 32 : 10;
+    for (int i = 1; i < count; ++i) {
+        size *= pieceType(pieces[i]) == Pawn ? 48 : 64;
+    }
+    return size * 2;
+}
+
+uint64_t TablebaseMaterial::index(const int* squares, ChessColor sideToMove) const
+{
+    const bool pawns = hasPawns();
+    int flip = (squares[0] & 7) > 3 ? 7 : 0;
+    if (!pawns && (squares[0] >> 3) > 3) {
+        flip |= 56;
+    }
+    const int king = squares[0] ^ flip;
+    bool diagonal = !pawns && (king >> 3) > (king & 7);
+    // with the king on the diagonal the first piece off it decides, so a
+    // position and its mirror image share one index
+    if (!pawns && (king >> 3) == (king & 7)) {
+        for (int i = 1; i < count; ++i) {
+            const int square = squares[i] ^ flip;
+            if ((square >> 3) != (square & 7)) {
+                diagonal = (square >> 3) > (square & 7);
+                break;
+            }
+        }
+    }
+
+    uint64_t index = pawns ? (king >> 3) * 4 + (king & 7) : triangleIndex[foldSquare(squares[0], flip, diagonal)];
+    for (int i = 1; i < count; ++i) {
+        const int square = foldSquare(squares[i], flip, diagonal);
+        if (pieceType(pieces[i]) == Pawn) {
+            index = index * 48 + (square - 8);
+        } else {
+            index = index * 64 + square;
+        }
+    }
+    return index * 2 + sideToMove;
+}
+
+void TablebaseMaterial::position(uint64_t index, int* squares, ChessColor& sideToMove) const
+{
+    sideToMove = static_cast<ChessColor>(index & 1);
+    index >>= 1;
+    for (int i = count - 1; i > 0; --i) {
+        if (pieceType(pieces[i]) == Pawn) {
+            squares[i] = static_cast<int>(index % 48) + 8;
+            index /= 48;
+        } else {
+            squares[i] = static_cast<int>(index % 64);
+            index /= 64;
+        }
+    }
+    squares[0] = hasPawns() ? static_cast<int>(index / 4) * 8 + static_cast<int>(index % 4)
+                            : triangleSquares[index];
+}
+
+Tablebases::Tablebases()
+    : _byMaterial(materialCodes * materialCodes, nullptr)
+{
+}
+
+int Tablebases::open(const std::string& directory)
+{
+    std::error_code error;
+    int found = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.path().extension() == tableExtension && load(entry.path().string())) {
+            ++found;
+        }
+    }
+    return found;
+}
+
+bool Tablebases::load(const std::string& path)
+{
+    auto table = std::make_unique<Table>();
+    if (!TablebaseMaterial::fromName(std::filesystem::path(path).stem().string(), table->material)
+        || !table->file.open(path)) {
+        return false;
+    }
+    if (table->file.size() != sizeof(tableMagic) + table->material.size()
+        || std::memcmp(table->file.data(), tableMagic, sizeof(tableMagic)) != 0) {
+        return false;
+    }
+
+    const TablebaseMaterial& material = table->material;
+    const int slot = materialCode(material.pieces, material.count, White) * materialCodes
+                   + materialCode(material.pieces, material.count, Black);
+    if (_byMaterial[slot]) {
+        return false;
+    }
+    _byMaterial[slot] = table.get();
+    _tables.push_back(std::move(table));
+    return true;
+}
+
+void Tablebases::close()
+{
+    std::fill(_byMaterial.begin(), _byMaterial.end(), nullptr);
+    _tables.clear();
+}
+
+bool Tablebases::hasTable(const TablebaseMaterial& material) const
+{
+    return _byMaterial[materialCode(material.pieces, material.count, White) * materialCodes
+                       + materialCode(material.pieces, material.count, Black)] != nullptr;
+}
+
+bool Tablebases::probe(const Position& position, TablebaseResult& result) const
+{
+    const uint64_t occupied = position.occupancy();
+    if (_tables.empty() || countOnes(occupied) > tablebaseMaxPieces || position.castlingRights() != 0) {
+        return false;
+    }
+    // the position only keeps an en passant square a pawn can take on
+    if (position.enPassantSquare() >= 0) {
+        return false;
+    }
+
+    int squares[tablebaseMaxPieces];
+    int pieces[tablebaseMaxPieces];
+    int count = 0;
+    BitboardElement(occupied).forEachBit([&](int square) {
+        squares[count] = square;
+        pieces[count] = position.pieceOn(square);
+        ++count;
+    });
+    return probe(squares, pieces, count, position.sideToMove(), result);
+}
+
+bool Tablebases::probe(const int* squares, const int* pieces, int count, ChessColor sideToMove, TablebaseResult& result) const
+{
+    if (count == 2) {
+        result = TablebaseResult();
+        return true;
+    }
+    if (count > tablebaseMaxPieces) {
+        return false;
+    }
+
+    // the ending with colours swapped is stored from the other side
+    const int whiteCode = materialCode(pieces, count, White);
+    const int blackCode = materialCode(pieces, count, Black);
+    const Table* table = _byMaterial[whiteCode * materialCodes + blackCode];
+    const bool swapColors = table == nullptr;
+    if (swapColors) {
+        table = _byMaterial[blackCode * materialCodes + whiteCode];
+        if (!table) {
+            return false;
+        }
+    }
+
+    // put the squares in the table's piece order
+    const TablebaseMaterial& material = table->material;
+    int ordered[tablebaseMaxPieces];
+    bool used[tablebaseMaxPieces] = {};
+    for (int slot = 0; slot < material.count; ++slot) {
+        for (int i = 0; i < count; ++i) {
+            const int piece = swapColors ? pieces[i] ^ 8 : pieces[i];
+            if (!used[i] && piece == material.pieces[slot]) {
+                used[i] = true;
+                ordered[slot] = swapColors ? squares[i] ^ 56 : squares[i];
+                break;
+            }
+        }
+    }
+
+    const ChessColor side = swapColors ? opposite(sideToMove) : sideToMove;
+    const uint8_t entry = table->file.data()[sizeof(tableMagic) + material.index(ordered, side)];
+    if (entry == invalidEntry) {
+        return false;
+    }
+    result = decodeEntry(entry);
+    return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "Position.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// Endgame tablebases for every ending of up to four pieces, kings included.
+//
+// A table file is the magic "CHESSTB1" followed by one byte per position:
+// 0 for a draw, 255 for an index no legal position maps to, and otherwise
+// one more than the plies to mate with best play. An odd ply count is a
+// win for the side to move and an even one a loss, so the byte carries
+// both the result and the distance to mate. Files are built by retrograde
+// analysis (TablebaseGenerator.h) and memory mapped for probing.
+//
+// Castling and en passant are not part of the index, and the fifty-move
+// rule is ignored, so positions with castling rights or an en passant
+// capture on the board are never probed.
+//
+constexpr int tablebaseMaxPieces = 4;
+
+enum TablebaseWdl
+{
+    TablebaseLoss = -1,
+    TablebaseDraw = 0,
+    TablebaseWin = 1
+};
+
+struct TablebaseResult
+{
+    TablebaseWdl wdl = TablebaseDraw;
+    int plies = 0;          // to mate, for a win or a loss
+};
+
+//
+// The pieces of one table in index order: the white king, the black king,
+// then the other white pieces and the other black pieces, strongest first.
+// White always has the stronger side; probes of the mirrored ending swap
+// the colours.
+//
+struct TablebaseMaterial
+{
+    int count = 2;
+    int pieces[tablebaseMaxPieces] = { makePiece(White, King), makePiece(Black, King) };
+
+    // sorted, and with the stronger side as white
+    static TablebaseMaterial fromPieces(std::vector<ChessPiece> white, std::vector<ChessPiece> black);
+    // "KQvKR"; false for a name that isn't a canonical ending of up to four pieces
+    static bool fromName(const std::string& name, TablebaseMaterial& material);
+    std::string name() const;
+    bool hasPawns() const;
+    // positions in the table, both sides to move
+    uint64_t size() const;
+
+    // Index of the position with the table's pieces on squares. Pawnless
+    // positions are folded by all eight board symmetries so the white king
+    // lands in the a1-d1-d4 triangle, and below the diagonal the first
+    // piece that is off it; with pawns only the files mirror.
+    uint64_t index(const int* squares, ChessColor sideToMove) const;
+    // the squares and side of an index, already folded; indices that fold
+    // to another one decode to positions index() never returns them for
+    void position(uint64_t index, int* squares, ChessColor& sideToMove) const;
+};
+
+class Tablebases
+{
+public:
+    Tablebases();
+
+    // maps every table file in directory; returns how many were found
+    int open(const std::string& directory);
+    // maps one table file, named after its material
+    bool load(const std::string& path);
+    void close();
+    int tableCount() const { return static_cast<int>(_tables.size()); }
+    bool hasTable(const TablebaseMaterial& material) const;
+
+    // Bare kings count as a draw. False when the position has too many
+    // pieces, castling rights or an en passant capture, or no table is
+    // loaded for its material.
+    bool probe(const Position& position, TablebaseResult& result) const;
+    // the same for count pieces given by square and piece code
+    bool probe(const int* squares, const int* pieces, int count, ChessColor sideToMove, TablebaseResult& result) const;
+
+private:
+    struct Table
+    {
+        TablebaseMaterial material;
+        MappedFile file;
+    };
+
+    // tables by the material codes of white and black
+    std::vector<std::unique_ptr<Table>> _tables;
+    std::vector<const Table*> _byMaterial;
+};
+
+extern Tablebases tablebases;
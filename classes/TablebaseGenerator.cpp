@@ -0,0 +1,730 @@
+#include "TablebaseGenerator.h"
+#include "MagicBitboards.h"
+#include "MoveGen.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+    constexpr uint8_t invalidEntry = 255;
+    // entries are plies + 1, so the longest mate a byte can hold
+    constexpr int maxLevel = 253;
+    // best result of the moves that leave the table: none, a draw, or a
+    // win or loss coded like an entry
+    constexpr uint8_t noExit = 0;
+    constexpr uint8_t drawExit = 255;
+    // two queens and a king have at most 62 moves, or moves back
+    constexpr int maxChildren = 64;
+    constexpr uint64_t chunkSize = 1 << 14;
+
+    template <typename Func>
+    void parallelFor(uint64_t size, int threads, const Func& func)
+    {
+        std::atomic<uint64_t> next(0);
+        auto worker = [&]() {
+            for (uint64_t begin = next.fetch_add(chunkSize); begin < size; begin = next.fetch_add(chunkSize)) {
+                const uint64_t end = std::min(size, begin + chunkSize);
+                for (uint64_t index = begin; index < end; ++index) {
+                    func(index);
+                }
+            }
+        };
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < threads; ++i) {
+            helpers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+    }
+
+    // A result as one number that orders like a search score: a win is
+    // higher the sooner it mates, a loss the longer it holds out
+    constexpr int mateScore = 1000;
+
+    int resultScore(const TablebaseResult& result)
+    {
+        if (result.wdl == TablebaseWin) return mateScore - result.plies;
+        if (result.wdl == TablebaseLoss) return -mateScore + result.plies;
+        return 0;
+    }
+
+    // the score one ply up from a child's, for the side that moved there
+    int parentScore(int childScore)
+    {
+        if (childScore > 0) return -childScore + 1;
+        if (childScore < 0) return -childScore - 1;
+        return 0;
+    }
+
+    bool bestMoveScore(const Tablebases& tables, Position& position, int& score);
+
+    // The tables' score of a position, or with an en passant capture on
+    // the board, which keeps it out of them, the best of its moves'
+    bool tableScore(const Tablebases& tables, Position& position, int& score)
+    {
+        TablebaseResult result;
+        if (tables.probe(position, result)) {
+            score = resultScore(result);
+            return true;
+        }
+        return position.enPassantSquare() >= 0 && bestMoveScore(tables, position, score);
+    }
+
+    // false if a move leads somewhere the tables don't cover
+    bool bestMoveScore(const Tablebases& tables, Position& position, int& score)
+    {
+        MoveList moves;
+        generateLegalMoves(position, moves);
+        if (moves.empty()) {
+            score = position.inCheck() ? -mateScore : 0;
+            return true;
+        }
+        score = -mateScore;
+        for (const BitMove& move : moves) {
+            position.makeMove(move);
+            int childScore;
+            const bool covered = tableScore(tables, position, childScore);
+            position.unmakeMove(move);
+            if (!covered) {
+                return false;
+            }
+            score = std::max(score, parentScore(childScore));
+        }
+        return true;
+    }
+
+    uint64_t attacks(int piece, int square, uint64_t occupied)
+    {
+        switch (pieceType(piece)) {
+        case Pawn:
+            return pieceColor(piece) == White ? WHITE_PAWN_ATTACKS(1ULL << square) : BLACK_PAWN_ATTACKS(1ULL << square);
+        case Knight:
+            return KnightAttacks[square];
+        case Bishop:
+            return getBishopAttacks(square, occupied);
+        case Rook:
+            return getRookAttacks(square, occupied);
+        case Queen:
+            return getQueenAttacks(square, occupied);
+        case King:
+            return KingAttacks[square];
+        default:
+            return 0;
+        }
+    }
+
+    // Up to four pieces by square, in table order while they stay in the table
+    struct Board
+    {
+        int count;
+        int squares[tablebaseMaxPieces];
+        int pieces[tablebaseMaxPieces];
+        ChessColor sideToMove;
+
+        uint64_t occupied() const
+        {
+            uint64_t occupied = 0;
+            for (int i = 0; i < count; ++i) {
+                occupied |= 1ULL << squares[i];
+            }
+            return occupied;
+        }
+
+        int kingSquare(ChessColor color) const
+        {
+            for (int i = 0; i < count; ++i) {
+                if (pieces[i] == makePiece(color, King)) {
+                    return squares[i];
+                }
+            }
+            return -1;
+        }
+
+        bool attacked(int square, ChessColor byColor) const
+        {
+            const uint64_t occupied = this->occupied();
+            for (int i = 0; i < count; ++i) {
+                if (pieceColor(pieces[i]) == byColor && (attacks(pieces[i], squares[i], occupied) & (1ULL << square))) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    // Calls visit(child, stays) for every legal move; stays is false for
+    // captures and promotions, which leave the table for a smaller one
+    template <typename Visit>
+    void forEachMove(const Board& board, const Visit& visit)
+    {
+        const ChessColor us = board.sideToMove;
+        const uint64_t occupied = board.occupied();
+        uint64_t own = 0;
+        for (int i = 0; i < board.count; ++i) {
+            if (pieceColor(board.pieces[i]) == us) {
+                own |= 1ULL << board.squares[i];
+            }
+        }
+
+        auto play = [&](int mover, int to, int promotion) {
+            Board child = board;
+            child.sideToMove = opposite(us);
+            child.squares[mover] = to;
+            bool stays = promotion == NoPiece;
+            if (promotion != NoPiece) {
+                child.pieces[mover] = makePiece(us, static_cast<ChessPiece>(promotion));
+            }
+            for (int i = 0; i < board.count; ++i) {
+                if (i != mover && board.squares[i] == to) {
+                    std::copy(child.squares + i + 1, child.squares + child.count, child.squares + i);
+                    std::copy(child.pieces + i + 1, child.pieces + child.count, child.pieces + i);
+                    --child.count;
+                    stays = false;
+                    break;
+                }
+            }
+            if (!child.attacked(child.kingSquare(us), opposite(us))) {
+                visit(child, stays);
+            }
+        };
+
+        for (int i = 0; i < board.count; ++i) {
+            if (pieceColor(board.pieces[i]) != us) {
+                continue;
+            }
+            const int from = board.squares[i];
+            uint64_t targets;
+            if (pieceType(board.pieces[i]) == Pawn) {
+                const int forward = us == White ? 8 : -8;
+                const int startRank = us == White ? 1 : 6;
+                targets = attacks(board.pieces[i], from, occupied) & occupied & ~own;
+                if (!(occupied & (1ULL << (from + forward)))) {
+                    targets |= 1ULL << (from + forward);
+                    if ((from >> 3) == startRank && !(occupied & (1ULL << (from + 2 * forward)))) {
+                        targets |= 1ULL << (from + 2 * forward);
+                    }
+                }
+            } else {
+                targets = attacks(board.pieces[i], from, occupied) & ~own;
+            }
+
+            BitboardElement(targets).forEachBit([&](int to) {
+                if (pieceType(board.pieces[i]) == Pawn && (to >> 3 == 0 || to >> 3 == 7)) {
+                    for (int promotion = Queen; promotion >= Knight; --promotion) {
+                        play(i, to, promotion);
+                    }
+                } else {
+                    play(i, to, NoPiece);
+                }
+            });
+        }
+    }
+
+    // the exit entry for the mover, from the entry of the position reached
+    uint8_t exitFromChild(const TablebaseResult& child)
+    {
+        if (child.wdl == TablebaseDraw) {
+            return drawExit;
+        }
+        return static_cast<uint8_t>(child.plies + 2);
+    }
+
+    // wins sooner beat wins later, then draws, then losses later beat losses sooner
+    int exitRank(uint8_t exit)
+    {
+        if (exit == noExit) {
+            return -1;
+        }
+        if (exit == drawExit) {
+            return 500;
+        }
+        const int plies = exit - 1;
+        return (plies & 1) ? 1000 - plies : plies;
+    }
+
+    // the exit entry of a move out of the table, for the side that made it
+    uint8_t probeExit(const Tablebases& smaller, const Board& child)
+    {
+        TablebaseResult result;
+        smaller.probe(child.squares, child.pieces, child.count, child.sideToMove, result);
+        return exitFromChild(result);
+    }
+
+    // The best en passant capture for the side to move in board, straight
+    // after the pawn in slot pushed moved two squares, as an exit entry
+    uint8_t enPassantExit(const Board& board, int pushed, const Tablebases& smaller)
+    {
+        const ChessColor us = board.sideToMove;
+        const int passed = board.squares[pushed] + (us == White ? 8 : -8);
+        uint8_t best = noExit;
+        for (int i = 0; i < board.count; ++i) {
+            if (board.pieces[i] != makePiece(us, Pawn) || !(attacks(board.pieces[i], board.squares[i], 0) & (1ULL << passed))) {
+                continue;
+            }
+            Board child = board;
+            child.sideToMove = opposite(us);
+            child.squares[i] = passed;
+            std::copy(child.squares + pushed + 1, child.squares + child.count, child.squares + pushed);
+            std::copy(child.pieces + pushed + 1, child.pieces + child.count, child.pieces + pushed);
+            --child.count;
+            if (!child.attacked(child.kingSquare(us), opposite(us))) {
+                const uint8_t candidate = probeExit(smaller, child);
+                if (exitRank(candidate) > exitRank(best)) {
+                    best = candidate;
+                }
+            }
+        }
+        return best;
+    }
+
+    // slot of the pawn that just moved two squares from board to child, or -1
+    int doublePushed(const Board& board, const Board& child)
+    {
+        for (int i = 0; i < board.count; ++i) {
+            if (pieceType(board.pieces[i]) == Pawn && std::abs(child.squares[i] - board.squares[i]) == 16) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    class Generator
+    {
+    public:
+        Generator(const TablebaseMaterial& material, const Tablebases& smaller, int threads)
+            : _material(material), _smaller(smaller), _threads(std::max(1, threads)), _size(material.size()),
+              _entries(new std::atomic<uint8_t>[_size]), _counters(new std::atomic<uint8_t>[_size]),
+              _exits(new uint8_t[_size]), _longestExit(0)
+        {
+        }
+
+        void solve()
+        {
+            parallelFor(_size, _threads, [this](uint64_t index) { initialise(index); });
+
+            int quietLevels = 0;
+            for (int level = 0; level <= maxLevel; ++level) {
+                std::atomic<uint64_t> decided(0);
+                parallelFor(_size, _threads, [this, level](uint64_t index) { decide(index, level); });
+                decided += decideEnPassant(level);
+                parallelFor(_size, _threads, [this, level, &decided](uint64_t index) {
+                    if (_entries[index].load(std::memory_order_relaxed) == level + 1) {
+                        decided.fetch_add(1, std::memory_order_relaxed);
+                        propagate(index, level);
+                    }
+                });
+                // a ply with nothing decided that the next can't use either
+                quietLevels = decided ? 0 : quietLevels + 1;
+                if (quietLevels >= 2 && level > _longestExit) {
+                    break;
+                }
+            }
+        }
+
+        bool write(const std::string& path, TablebaseStats& stats) const
+        {
+            std::vector<char> data(_size);
+            stats = TablebaseStats();
+            for (uint64_t index = 0; index < _size; ++index) {
+                const uint8_t entry = _entries[index].load(std::memory_order_relaxed);
+                data[index] = static_cast<char>(entry);
+                if (entry == invalidEntry) {
+                    continue;
+                }
+                stats.positions++;
+                if (entry == 0) {
+                    stats.draws++;
+                } else if ((entry - 1) & 1) {
+                    stats.wins++;
+                    stats.longestMate = std::max(stats.longestMate, entry - 1);
+                } else {
+                    stats.losses++;
+                }
+            }
+
+            std::ofstream file(path, std::ios::binary);
+            file.write("CHESSTB1", 8);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            return static_cast<bool>(file);
+        }
+
+    private:
+        bool decode(uint64_t index, Board& board) const
+        {
+            board.count = _material.count;
+            std::copy(_material.pieces, _material.pieces + _material.count, board.pieces);
+            _material.position(index, board.squares, board.sideToMove);
+
+            const uint64_t occupied = board.occupied();
+            if (countOnes(occupied) != board.count || _material.index(board.squares, board.sideToMove) != index) {
+                return false;
+            }
+            const int whiteKing = board.squares[0];
+            const int blackKing = board.squares[1];
+            if (KingAttacks[whiteKing] & (1ULL << blackKing)) {
+                return false;
+            }
+            // the side that just moved can't have left its king in check
+            return !board.attacked(board.kingSquare(opposite(board.sideToMove)), board.sideToMove);
+        }
+
+        // Counts the distinct positions in the table a move reaches and
+        // settles the best of the moves that leave it. Positions rather
+        // than moves are counted because the symmetry folding can map two
+        // moves to one index, and propagate() visits each index once.
+        void initialise(uint64_t index)
+        {
+            Board board;
+            if (!decode(index, board)) {
+                _entries[index].store(invalidEntry, std::memory_order_relaxed);
+                _counters[index].store(0, std::memory_order_relaxed);
+                _exits[index] = noExit;
+                return;
+            }
+
+            uint64_t children[maxChildren];
+            int childCount = 0;
+            int enPassantChildren = 0;
+            uint8_t exit = noExit;
+            bool anyMove = false;
+            forEachMove(board, [&](const Board& child, bool stays) {
+                anyMove = true;
+                if (stays) {
+                    const uint64_t childIndex = _material.index(child.squares, child.sideToMove);
+                    const int pushed = doublePushed(board, child);
+                    const uint8_t enPassant = pushed >= 0 ? enPassantExit(child, pushed, _smaller) : noExit;
+                    if (enPassant == noExit) {
+                        children[childCount++] = childIndex;
+                    } else {
+                        noteExit(enPassant);
+                        enPassantChildren++;
+                        std::lock_guard<std::mutex> lock(_enPassantMutex);
+                        _enPassantMoves.push_back({ index, childIndex, enPassant, false });
+                    }
+                    return;
+                }
+                const uint8_t candidate = probeExit(_smaller, child);
+                if (exitRank(candidate) > exitRank(exit)) {
+                    exit = candidate;
+                }
+            });
+            std::sort(children, children + childCount);
+            childCount = static_cast<int>(std::unique(children, children + childCount) - children) + enPassantChildren;
+
+            // stalemate
+            if (!anyMove && !board.attacked(board.kingSquare(board.sideToMove), opposite(board.sideToMove))) {
+                exit = drawExit;
+            }
+            noteExit(exit);
+            _entries[index].store(0, std::memory_order_relaxed);
+            _counters[index].store(static_cast<uint8_t>(childCount), std::memory_order_relaxed);
+            _exits[index] = exit;
+        }
+
+        void noteExit(uint8_t exit)
+        {
+            if (exit != noExit && exit != drawExit) {
+                int longest = _longestExit.load(std::memory_order_relaxed);
+                while (exit > longest && !_longestExit.compare_exchange_weak(longest, exit)) {
+                }
+            }
+        }
+
+        // Settles positions lost or won in exactly level plies that the
+        // last propagate() didn't. A loss needs every move to lose: all the
+        // moves that stay have been answered by a win, and leaving does no
+        // better than a loss this long. Mates are the losses of level 0.
+        void decide(uint64_t index, int level)
+        {
+            if (_entries[index].load(std::memory_order_relaxed) != 0) {
+                return;
+            }
+            const uint8_t exit = _exits[index];
+            bool decided;
+            if (level & 1) {
+                decided = exit != noExit && exit != drawExit && exit - 1 == level;
+            } else {
+                decided = _counters[index].load(std::memory_order_relaxed) == 0
+                       && (exit == noExit || (exit != drawExit && !((exit - 1) & 1) && exit - 1 <= level));
+            }
+            if (decided) {
+                _entries[index].store(static_cast<uint8_t>(level + 1), std::memory_order_relaxed);
+            }
+        }
+
+        // A double push that allows en passant reaches the table's position
+        // plus the capture, so the side to take picks the better of the two.
+        // It wins as soon as either wins and loses once both have lost.
+        // Returns how many were settled at level.
+        uint64_t decideEnPassant(int level)
+        {
+            uint64_t decided = 0;
+            for (EnPassantMove& move : _enPassantMoves) {
+                if (move.decided) {
+                    continue;
+                }
+                const uint8_t entry = _entries[move.child].load(std::memory_order_relaxed);
+                const bool captureWins = move.capture != drawExit && ((move.capture - 1) & 1);
+                if (level & 1) {
+                    move.decided = entry == level + 1 || (captureWins && move.capture - 1 == level);
+                    if (move.decided) {
+                        _counters[move.parent].fetch_sub(1, std::memory_order_relaxed);
+                    }
+                } else {
+                    const bool childLost = entry != 0 && !((entry - 1) & 1) && entry - 1 <= level;
+                    const bool captureLost = move.capture != drawExit && !captureWins && move.capture - 1 <= level;
+                    move.decided = childLost && captureLost;
+                    if (move.decided) {
+                        uint8_t undecided = 0;
+                        _entries[move.parent].compare_exchange_strong(undecided, static_cast<uint8_t>(level + 2),
+                                                                      std::memory_order_relaxed);
+                    }
+                }
+                decided += move.decided;
+            }
+            return decided;
+        }
+
+        // Every position one move before a loss in level plies wins in
+        // level + 1; one before a win has a move fewer left that doesn't lose.
+        void propagate(uint64_t index, int level)
+        {
+            Board board;
+            decode(index, board);
+            const ChessColor mover = opposite(board.sideToMove);
+            const uint64_t occupied = board.occupied();
+
+            uint64_t parents[maxChildren];
+            int parentCount = 0;
+            Board parent = board;
+            parent.sideToMove = mover;
+            for (int i = 0; i < board.count; ++i) {
+                if (pieceColor(board.pieces[i]) != mover) {
+                    continue;
+                }
+                const int to = board.squares[i];
+                uint64_t origins;
+                if (pieceType(board.pieces[i]) == Pawn) {
+                    const int back = mover == White ? -8 : 8;
+                    const int pushedRank = mover == White ? 3 : 4;
+                    const int homeRank = mover == White ? 0 : 7;
+                    origins = 0;
+                    const int single = to + back;
+                    if ((single >> 3) != homeRank && !(occupied & (1ULL << single))) {
+                        origins |= 1ULL << single;
+                        if ((to >> 3) == pushedRank && !(occupied & (1ULL << (single + back)))) {
+                            origins |= 1ULL << (single + back);
+                        }
+                    }
+                } else {
+                    origins = attacks(board.pieces[i], to, occupied) & ~occupied;
+                }
+                BitboardElement(origins).forEachBit([&](int from) {
+                    // double pushes that allow en passant are decideEnPassant()'s
+                    if (std::abs(to - from) == 16 && pieceType(board.pieces[i]) == Pawn
+                        && enPassantExit(board, i, _smaller) != noExit) {
+                        return;
+                    }
+                    parent.squares[i] = from;
+                    const uint64_t parentIndex = _material.index(parent.squares, mover);
+                    if (_entries[parentIndex].load(std::memory_order_relaxed) != invalidEntry) {
+                        parents[parentCount++] = parentIndex;
+                    }
+                });
+                parent.squares[i] = to;
+            }
+            std::sort(parents, parents + parentCount);
+            parentCount = static_cast<int>(std::unique(parents, parents + parentCount) - parents);
+
+            for (int i = 0; i < parentCount; ++i) {
+                if (level & 1) {
+                    _counters[parents[i]].fetch_sub(1, std::memory_order_relaxed);
+                } else {
+                    uint8_t undecided = 0;
+                    _entries[parents[i]].compare_exchange_strong(undecided, static_cast<uint8_t>(level + 2),
+                                                                 std::memory_order_relaxed);
+                }
+            }
+        }
+
+        struct EnPassantMove
+        {
+            uint64_t parent;
+            uint64_t child;
+            uint8_t capture;    // the best en passant capture, as an exit entry
+            bool decided;
+        };
+
+        const TablebaseMaterial& _material;
+        const Tablebases& _smaller;
+
+        int _threads;
+        uint64_t _size;
+        std::unique_ptr<std::atomic<uint8_t>[]> _entries;
+        std::unique_ptr<std::atomic<uint8_t>[]> _counters;
+        std::unique_ptr<uint8_t[]> _exits;
+        std::atomic<int> _longestExit;
+        std::mutex _enPassantMutex;
+        std::vector<EnPassantMove> _enPassantMoves;
+    };
+
+    void addCanonical(std::vector<TablebaseMaterial>& materials, const TablebaseMaterial& material)
+    {
+        if (material.count <= 2) {
+            return;
+        }
+        for (const TablebaseMaterial& known : materials) {
+            if (known.name() == material.name()) {
+                return;
+            }
+        }
+        materials.push_back(material);
+    }
+
+    int pawnCount(const TablebaseMaterial& material)
+    {
+        int pawns = 0;
+        for (int i = 2; i < material.count; ++i) {
+            pawns += pieceType(material.pieces[i]) == Pawn;
+        }
+        return pawns;
+    }
+}
+
+std::vector<TablebaseMaterial> allTablebaseMaterials()
+{
+    std::vector<TablebaseMaterial> materials;
+    for (int first = Pawn; first <= Queen; ++first) {
+        addCanonical(materials, TablebaseMaterial::fromPieces({ static_cast<ChessPiece>(first) }, {}));
+        for (int second = Pawn; second <= Queen; ++second) {
+            addCanonical(materials, TablebaseMaterial::fromPieces({ static_cast<ChessPiece>(first), static_cast<ChessPiece>(second) }, {}));
+            addCanonical(materials, TablebaseMaterial::fromPieces({ static_cast<ChessPiece>(first) }, { static_cast<ChessPiece>(second) }));
+        }
+    }
+
+    // captures lead to fewer pieces and promotions to fewer pawns
+    std::stable_sort(materials.begin(), materials.end(), [](const TablebaseMaterial& a, const TablebaseMaterial& b) {
+        return a.count != b.count ? a.count < b.count : pawnCount(a) < pawnCount(b);
+    });
+    return materials;
+}
+
+std::vector<TablebaseMaterial> tablebaseSuccessors(const TablebaseMaterial& material)
+{
+    std::vector<ChessPiece> sides[2];
+    for (int i = 2; i < material.count; ++i) {
+        sides[pieceColor(material.pieces[i])].push_back(pieceType(material.pieces[i]));
+    }
+
+    std::vector<TablebaseMaterial> successors;
+    for (int color = White; color <= Black; ++color) {
+        for (size_t i = 0; i < sides[color].size(); ++i) {
+            std::vector<ChessPiece> changed[2] = { sides[0], sides[1] };
+            changed[color].erase(changed[color].begin() + i);
+            addCanonical(successors, TablebaseMaterial::fromPieces(changed[White], changed[Black]));
+
+            if (sides[color][i] != Pawn) {
+                continue;
+            }
+            for (int promotion = Knight; promotion <= Queen; ++promotion) {
+                std::vector<ChessPiece> promoted[2] = { sides[0], sides[1] };
+                promoted[color][i] = static_cast<ChessPiece>(promotion);
+                addCanonical(successors, TablebaseMaterial::fromPieces(promoted[White], promoted[Black]));
+                // promoting with a capture
+                for (size_t j = 0; j < sides[color ^ 1].size(); ++j) {
+                    std::vector<ChessPiece> captured[2] = { promoted[0], promoted[1] };
+                    captured[color ^ 1].erase(captured[color ^ 1].begin() + j);
+                    addCanonical(successors, TablebaseMaterial::fromPieces(captured[White], captured[Black]));
+                }
+            }
+        }
+    }
+    return successors;
+}
+
+bool generateTablebase(const TablebaseMaterial& material, const Tablebases& smaller, const std::string& path,
+                       int threads, TablebaseStats& stats)
+{
+    for (const TablebaseMaterial& successor : tablebaseSuccessors(material)) {
+        if (!smaller.hasTable(successor)) {
+            return false;
+        }
+    }
+
+    Generator generator(material, smaller, threads);
+    generator.solve();
+    return generator.write(path, stats);
+}
+
+bool verifyTablebase(const TablebaseMaterial& material, const Tablebases& tables, int threads, TablebaseStats& stats)
+{
+    if (!tables.hasTable(material)) {
+        return false;
+    }
+
+    std::atomic<uint64_t> positions(0), wins(0), draws(0), losses(0), mismatches(0), uncovered(0);
+    std::atomic<int> longestMate(0);
+    parallelFor(material.size(), threads, [&](uint64_t index) {
+        // every position once, at the index it folds to
+        int squares[tablebaseMaxPieces];
+        ChessColor sideToMove;
+        material.position(index, squares, sideToMove);
+        if (material.index(squares, sideToMove) != index) {
+            return;
+        }
+        std::string state(64, pieceToChar(0));
+        for (int i = 0; i < material.count; ++i) {
+            if (state[squares[i]] != pieceToChar(0)) {
+                return;
+            }
+            state[squares[i]] = pieceToChar(material.pieces[i]);
+        }
+
+        thread_local Position position;
+        position.setFromState(state, sideToMove);
+        TablebaseResult result;
+        const bool covered = tables.probe(position, result);
+        if (position.isSquareAttacked(position.kingSquare(opposite(sideToMove)), sideToMove)) {
+            if (covered) {
+                mismatches++;
+            }
+            return;
+        }
+
+        int expected;
+        if (!bestMoveScore(tables, position, expected)) {
+            uncovered++;
+            return;
+        }
+        positions++;
+        if (!covered || resultScore(result) != expected) {
+            mismatches++;
+            return;
+        }
+        if (result.wdl == TablebaseWin) {
+            wins++;
+            int longest = longestMate.load(std::memory_order_relaxed);
+            while (result.plies > longest && !longestMate.compare_exchange_weak(longest, result.plies)) {
+            }
+        } else if (result.wdl == TablebaseLoss) {
+            losses++;
+        } else {
+            draws++;
+        }
+    });
+
+    stats = TablebaseStats();
+    stats.positions = positions;
+    stats.wins = wins;
+    stats.draws = draws;
+    stats.losses = losses;
+    stats.longestMate = longestMate;
+    stats.mismatches = mismatches;
+    return uncovered == 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Tablebase.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TablebaseStats
+{
+    uint64_t positions = 0;     // legal ones, both sides to move
+    uint64_t wins = 0;
+    uint64_t draws = 0;
+    uint64_t losses = 0;
+    int longestMate = 0;        // plies
+    uint64_t mismatches = 0;    // entries verifyTablebase() found wrong
+};
+
+// every ending of three and four pieces, each after the ones it can reach
+std::vector<TablebaseMaterial> allTablebaseMaterials();
+// the smaller endings one capture or promotion from material leads into
+std::vector<TablebaseMaterial> tablebaseSuccessors(const TablebaseMaterial& material);
+
+//
+// Solves material by retrograde analysis and writes the table to path.
+// Mates and the results of leaving the ending are found first; then each
+// pass walks back one ply from the positions decided by the last, until
+// nothing changes and the rest are draws. Passes are split over threads.
+// Every successor table must already be loaded in smaller; returns false
+// if one is missing or the file can't be written.
+//
+bool generateTablebase(const TablebaseMaterial& material, const Tablebases& smaller, const std::string& path,
+                       int threads, TablebaseStats& stats);
+
+//
+// Checks every entry of material's loaded table against a one ply search
+// of its position with the engine's own move generator, scoring each
+// move from the tables: a legal position has to hold the best of its
+// moves' results one ply further on, and an illegal one mustn't probe.
+// Fills stats from the table and counts the entries that disagree; false
+// if the table or one the moves lead into isn't loaded.
+//
+bool verifyTablebase(const TablebaseMaterial& material, const Tablebases& tables, int threads, TablebaseStats& stats);
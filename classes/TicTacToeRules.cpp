@@ -0,0 +1,66 @@
+#include "TicTacToeRules.h"
+#include <algorithm>
+
+namespace {
+    const int winningTriples[8][3] = { {0,1,2}, {3,4,5}, {6,7,8},  // rows
+                                       {0,3,6}, {1,4,7}, {2,5,8},  // cols
+                                       {0,4,8}, {2,4,6} };         // diagonals
+
+    char playerMark(int playerNumber) { return static_cast<char>('1' + playerNumber); }
+
+    // score for the side to move; a finished line was made by the opponent
+    int negamax(std::string& state, int playerNumber)
+    {
+        if (ticTacToeWinner(state) >= 0) {
+            return -10;
+        }
+        if (ticTacToeBoardFull(state)) {
+            return 0;
+        }
+
+        int bestVal = -1000;
+        for (int cell = 0; cell < 9; ++cell) {
+            if (state[cell] == '0') {
+                state[cell] = playerMark(playerNumber);
+                bestVal = std::max(bestVal, -negamax(state, 1 - playerNumber));
+                state[cell] = '0';
+            }
+        }
+        return bestVal;
+    }
+}
+
+int ticTacToeWinner(const std::string& state)
+{
+    for (const int* triple : winningTriples) {
+        char first = state[triple[0]];
+        if (first != '0' && first == state[triple[1]] && first == state[triple[2]]) {
+            return first - '1';
+        }
+    }
+    return -1;
+}
+
+bool ticTacToeBoardFull(const std::string& state)
+{
+    return state.find('0') == std::string::npos;
+}
+
+int ticTacToeBestMove(const std::string& state, int playerNumber)
+{
+    std::string board = state;
+    int bestVal = -1000;
+    int bestCell = -1;
+    for (int cell = 0; cell < 9; ++cell) {
+        if (board[cell] == '0') {
+            board[cell] = playerMark(playerNumber);
+            int moveVal = -negamax(board, 1 - playerNumber);
+            board[cell] = '0';
+            if (moveVal > bestVal) {
+                bestVal = moveVal;
+                bestCell = cell;
+            }
+        }
+    }
+    return bestCell;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+//
+// Tic tac toe rules and search on the 9 character state string used by
+// TicTacToe::stateString(): '0' for an empty cell, otherwise the owner's
+// player number plus one, row by row.
+//
+
+// player number with three in a row, or -1
+int ticTacToeWinner(const std::string& state);
+bool ticTacToeBoardFull(const std::string& state);
+// Perfect play by full negamax; the cell index to play, or -1 if the board is full
+int ticTacToeBestMove(const std::string& state, int playerNumber);
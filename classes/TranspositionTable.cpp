@@ -0,0 +1,93 @@
+#include "TranspositionTable.h"
+
+namespace {
+    // data word layout: score 0-31, move 32-47, depth 48-55, bound 56-57
+    uint64_t packEntry(int depth, int score, TTBound bound, const BitMove& move)
+    {
+        return static_cast<uint32_t>(score)
+             | (static_cast<uint64_t>(move.data) << 32)
+             | (static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48)
+             | (static_cast<uint64_t>(bound) << 56);
+    }
+
+    TTEntry unpackEntry(uint64_t key, uint64_t data)
+    {
+        TTEntry entry;
+        entry.key = key;
+        entry.score = static_cast<int32_t>(static_cast<uint32_t>(data));
+        entry.move.data = static_cast<uint16_t>(data >> 32);
+        entry.depth = static_cast<int8_t>((data >> 48) & 0xff);
+        entry.bound = static_cast<TTBound>((data >> 56) & 3);
+        return entry;
+    }
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : _count(0), _mask(0), _megabytes(0)
+{
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    if (megabytes == 0) {
+        megabytes = 1;
+    }
+
+    size_t count = 1;
+    while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024) {
+        count *= 2;
+    }
+
+    _slots.reset();
+    _slots.reset(new Slot[count]);
+    _count = count;
+    _mask = count - 1;
+    _megabytes = megabytes;
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < _count; ++i) {
+        _slots[i].keyXorData.store(0, std::memory_order_relaxed);
+        _slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const
+{
+    const Slot& slot = _slots[key & _mask];
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const uint64_t keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+    if ((keyXorData ^ data) != key) {
+        return false;
+    }
+
+    entry = unpackEntry(key, data);
+    return entry.bound != BoundNone;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, TTBound bound, const BitMove& move)
+{
+    Slot& slot = _slots[key & _mask];
+    const uint64_t oldData = slot.data.load(std::memory_order_relaxed);
+    const bool sameKey = (slot.keyXorData.load(std::memory_order_relaxed) ^ oldData) == key;
+
+    BitMove bestMove = move;
+    if (sameKey) {
+        const TTEntry old = unpackEntry(key, oldData);
+        // Keep a deeper result for the same position unless this one is exact
+        if (old.depth > depth && bound != BoundExact) {
+            return;
+        }
+        // Don't lose a known best move to a fail-low that found none
+        if (move.isNull()) {
+            bestMove = old.move;
+        }
+    }
+
+    const uint64_t data = packEntry(depth, score, bound, bestMove);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Bitboard.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum TTBound : uint8_t
+{
+    BoundNone,
+    BoundUpper,     // search failed low; score is at most this
+    BoundLower,     // search failed high; score is at least this
+    BoundExact
+};
+
+struct TTEntry
+{
+    uint64_t key;
+    int32_t score;
+    BitMove move;
+    int8_t depth;
+    TTBound bound;
+};
+
+//
+// Fixed size hash table of search results keyed by Zobrist key. The entry
+// count is always a power of two so the slot is just the low key bits.
+//
+// Search threads share one table without locks. Each slot is two words:
+// the packed entry, and the key XORed with it. A slot torn by two threads
+// writing at once no longer XORs back to its key, so probe() rejects it.
+//
+class TranspositionTable
+{
+public:
+    explicit TranspositionTable(size_t megabytes = defaultMegabytes);
+
+    static constexpr size_t defaultMegabytes = 16;
+
+    // reallocate to the largest power of two entry count fitting megabytes;
+    // must not be called while a search is using the table
+    void resize(size_t megabytes);
+    void clear();
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, int depth, int score, TTBound bound, const BitMove& move);
+
+    size_t megabytes() const { return _megabytes; }
+    size_t entryCount() const { return _count; }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    size_t _count;
+    uint64_t _mask;
+    size_t _megabytes;
+};
@@ -0,0 +1,342 @@
+#include "UciEngine.h"
+#include "Evaluate.h"
+#include "MoveGen.h"
+#include "Tablebase.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+    const char* startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    constexpr int maxHashMegabytes = 4096;
+    constexpr int maxThreads = 256;
+    constexpr int maxMultiPV = 16;
+    // time held back on every move for the GUI and the pipe to catch up
+    constexpr int moveOverhead = 30;
+    // moves assumed to be left when the GUI doesn't send movestogo
+    constexpr int defaultMovesToGo = 30;
+
+    // Spend an even share of the clock over the moves still to play plus
+    // most of the increment, but never more than a third of what is left.
+    // The hard limit lets an iteration that is nearly done finish.
+    void allocateTime(SearchLimits& limits, int remaining, int increment, int movesToGo)
+    {
+        const int usable = std::max(1, remaining - moveOverhead);
+        const int moves = movesToGo > 0 ? movesToGo : defaultMovesToGo;
+        limits.softTime = std::max(1, std::min(usable / moves + increment * 3 / 4, usable / 3));
+        limits.hardTime = std::max(limits.softTime, std::min(limits.softTime * 4, usable / 2));
+    }
+
+    std::string scoreToUci(int score)
+    {
+        if (score >= mateBound) {
+            return "mate " + std::to_string((mateValue - score + 1) / 2);
+        }
+        if (score <= -mateBound) {
+            return "mate " + std::to_string(-(mateValue + score) / 2);
+        }
+        return "cp " + std::to_string(score);
+    }
+
+    // one check option per selective search technique
+    struct PruningOption
+    {
+        const char* name;
+        bool SearchPruning::*flag;
+    };
+
+    const PruningOption pruningOptions[] = {
+        { "NullMove", &SearchPruning::nullMove },
+        { "LateMoveReductions", &SearchPruning::lateMoveReductions },
+        { "ReverseFutility", &SearchPruning::reverseFutility },
+        { "Futility", &SearchPruning::futility },
+        { "LateMovePruning", &SearchPruning::lateMovePruning },
+    };
+}
+
+UciEngine::UciEngine(std::istream& input, std::ostream& output)
+    : _input(input), _output(output), _searchPool(_transpositionTable),
+      _multiPV(1), _bookRandom(std::random_device()()), _ownBook(false), _stopRequested(false), _infinite(false), _pondering(false)
+{
+    _position.setFromFen(startFen);
+    _searchPool.setInfoCallback([this](const SearchResult& result) {
+        for (size_t i = 0; i < result.lines.size(); ++i) {
+            send(infoLine(result, static_cast<int>(i)));
+        }
+    });
+}
+
+UciEngine::~UciEngine()
+{
+    stopSearch();
+}
+
+void UciEngine::loop()
+{
+    std::string line;
+    while (std::getline(_input, line)) {
+        if (!handleCommand(line)) {
+            break;
+        }
+    }
+    stopSearch();
+}
+
+bool UciEngine::handleCommand(const std::string& line)
+{
+    std::istringstream args(line);
+    std::string command;
+    args >> command;
+
+    if (command == "uci") {
+        uci();
+    } else if (command == "isready") {
+        send("readyok");
+    } else if (command == "ucinewgame") {
+        stopSearch();
+        _transpositionTable.clear();
+    } else if (command == "setoption") {
+        setOption(args);
+    } else if (command == "position") {
+        setPosition(args);
+    } else if (command == "go") {
+        go(args);
+    } else if (command == "stop") {
+        stopSearch();
+    } else if (command == "ponderhit") {
+        ponderHit();
+    } else if (command == "quit") {
+        return false;
+    } else if (!command.empty()) {
+        send("info string unknown command " + command);
+    }
+    return true;
+}
+
+void UciEngine::uci()
+{
+    send("id name Chess");
+    send("id author Chess contributors");
+    send("option name Hash type spin default " + std::to_string(TranspositionTable::defaultMegabytes)
+         + " min 1 max " + std::to_string(maxHashMegabytes));
+    send("option name Threads type spin default 1 min 1 max " + std::to_string(maxThreads));
+    send("option name Ponder type check default false");
+    send("option name MultiPV type spin default 1 min 1 max " + std::to_string(maxMultiPV));
+    send("option name EvalFile type string default <empty>");
+    send("option name EvalNetwork type string default <empty>");
+    send("option name OwnBook type check default false");
+    send("option name BookFile type string default <empty>");
+    send("option name TablebasePath type string default <empty>");
+    for (const PruningOption& option : pruningOptions) {
+        send(std::string("option name ") + option.name + " type check default true");
+    }
+    send("uciok");
+}
+
+void UciEngine::setOption(std::istringstream& args)
+{
+    // setoption name <id> [value <x>]; both may contain spaces
+    std::string token, name, value;
+    std::string* field = nullptr;
+    while (args >> token) {
+        if (token == "name") {
+            field = &name;
+        } else if (token == "value") {
+            field = &value;
+        } else if (field) {
+            *field += field->empty() ? token : " " + token;
+        }
+    }
+
+    stopSearch();
+    if (name == "Hash") {
+        _transpositionTable.resize(std::clamp(std::atoi(value.c_str()), 1, maxHashMegabytes));
+    } else if (name == "Threads") {
+        _searchPool.setThreadCount(std::clamp(std::atoi(value.c_str()), 1, maxThreads));
+    } else if (name == "Ponder") {
+        // nothing to set up; the option only tells the GUI it may send go ponder
+    } else if (name == "MultiPV") {
+        _multiPV = std::clamp(std::atoi(value.c_str()), 1, maxMultiPV);
+    } else if (name == "EvalFile") {
+        // an empty path goes back to the built-in weights
+        if (value.empty() || value == "<empty>") {
+            setEvalParams(defaultEvalParams());
+        } else if (!loadEvalParams(value)) {
+            send("info string cannot load eval file " + value);
+        }
+    } else if (name == "EvalNetwork") {
+        if (value.empty() || value == "<empty>") {
+            nnue.unload();
+        } else if (nnue.load(value)) {
+            send(std::string("info string NNUE kernel ") + NnueNetwork::kernelName());
+        } else {
+            send("info string cannot load network " + value);
+        }
+    } else if (name == "OwnBook") {
+        _ownBook = value == "true";
+    } else if (name == "BookFile") {
+        _book.close();
+        if (!value.empty() && value != "<empty>" && !_book.open(value)) {
+            send("info string cannot open book " + value);
+        }
+    } else if (name == "TablebasePath") {
+        tablebases.close();
+        if (!value.empty() && value != "<empty>") {
+            send("info string found " + std::to_string(tablebases.open(value)) + " tablebases in " + value);
+        }
+    } else {
+        for (const PruningOption& option : pruningOptions) {
+            if (name == option.name) {
+                _pruning.*option.flag = value != "false";
+                return;
+            }
+        }
+        send("info string unknown option " + name);
+    }
+}
+
+void UciEngine::setPosition(std::istringstream& args)
+{
+    stopSearch();
+
+    std::string token;
+    args >> token;
+    if (token == "startpos") {
+        _position.setFromFen(startFen);
+        args >> token;
+    } else if (token == "fen") {
+        std::string fen;
+        while (args >> token && token != "moves") {
+            fen += fen.empty() ? token : " " + token;
+        }
+        if (!_position.setFromFen(fen)) {
+            send("info string invalid fen " + fen);
+            _position.setFromFen(startFen);
+            return;
+        }
+    } else {
+        return;
+    }
+
+    if (token != "moves") {
+        return;
+    }
+    while (args >> token) {
+        BitMove move = moveFromString(_position, token);
+        if (move.isNull()) {
+            send("info string illegal move " + token);
+            return;
+        }
+        _position.makeMove(move);
+    }
+}
+
+void UciEngine::go(std::istringstream& args)
+{
+    stopSearch();
+
+    SearchLimits limits;
+    limits.multiPV = _multiPV;
+    limits.pruning = _pruning;
+    int whiteTime = 0, blackTime = 0, whiteIncrement = 0, blackIncrement = 0, movesToGo = 0;
+    bool infinite = false;
+    std::string token;
+    while (args >> token) {
+        if (token == "depth") args >> limits.depth;
+        else if (token == "nodes") args >> limits.nodes;
+        else if (token == "movetime") args >> limits.movetime;
+        else if (token == "wtime") args >> whiteTime;
+        else if (token == "btime") args >> blackTime;
+        else if (token == "winc") args >> whiteIncrement;
+        else if (token == "binc") args >> blackIncrement;
+        else if (token == "movestogo") args >> movesToGo;
+        else if (token == "infinite") infinite = true;
+        else if (token == "ponder") limits.ponder = true;
+    }
+
+    // a book move is answered at once; pondering and analysis still search
+    if (_ownBook && !infinite && !limits.ponder) {
+        const BitMove bookMove = _book.pickMove(_position, _bookRandom);
+        if (!bookMove.isNull()) {
+            send("bestmove " + moveToString(bookMove));
+            return;
+        }
+    }
+
+    const bool white = _position.sideToMove() == White;
+    const int remaining = white ? whiteTime : blackTime;
+    if (!infinite && limits.movetime <= 0 && remaining > 0) {
+        allocateTime(limits, remaining, white ? whiteIncrement : blackIncrement, movesToGo);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_stopMutex);
+        _stopRequested = false;
+        _infinite = infinite;
+        _pondering = limits.ponder;
+    }
+    _searchPool.start(_position, limits);
+    _reporter = std::thread([this]() {
+        SearchResult result = _searchPool.wait();
+        {
+            std::unique_lock<std::mutex> lock(_stopMutex);
+            _stopCondition.wait(lock, [this]() { return (!_infinite && !_pondering) || _stopRequested; });
+        }
+        std::string reply = "bestmove " + (result.bestMove.isNull() ? std::string("0000") : moveToString(result.bestMove));
+        if (!result.lines.empty() && result.lines[0].pv.size() > 1) {
+            reply += " ponder " + moveToString(result.lines[0].pv[1]);
+        }
+        send(reply);
+    });
+}
+
+void UciEngine::ponderHit()
+{
+    {
+        std::lock_guard<std::mutex> lock(_stopMutex);
+        _pondering = false;
+    }
+    _searchPool.ponderHit();
+    _stopCondition.notify_all();
+}
+
+void UciEngine::stopSearch()
+{
+    if (!_reporter.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_stopMutex);
+        _stopRequested = true;
+    }
+    _stopCondition.notify_all();
+    _searchPool.stop();
+    _reporter.join();
+}
+
+void UciEngine::send(const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(_outputMutex);
+    _output << line << std::endl;
+}
+
+std::string UciEngine::infoLine(const SearchResult& result, int lineIndex) const
+{
+    const SearchLine& line = result.lines[lineIndex];
+    const int milliseconds = static_cast<int>(result.seconds * 1000.0);
+    const uint64_t nodesPerSecond = milliseconds > 0 ? result.nodes * 1000 / milliseconds : 0;
+    std::string info = "info depth " + std::to_string(result.depth)
+                     + " multipv " + std::to_string(lineIndex + 1)
+                     + " score " + scoreToUci(line.score)
+                     + " nodes " + std::to_string(result.nodes)
+                     + " nps " + std::to_string(nodesPerSecond)
+                     + " time " + std::to_string(milliseconds)
+                     + " tbhits " + std::to_string(result.tablebaseHits)
+                     + " pv";
+    for (const BitMove& move : line.pv) {
+        info += ' ';
+        info += moveToString(move);
+    }
+    return info;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Position.h"
+#include "TranspositionTable.h"
+#include "SearchPool.h"
+#include "PolyglotBook.h"
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+//
+// Universal Chess Interface front end for match managers and analysis
+// tools. Commands are read a line at a time; go hands the search to the
+// SearchPool worker, so stop and isready are answered while it thinks and
+// bestmove is sent from a reporter thread once the search ends.
+//
+class UciEngine
+{
+public:
+    UciEngine(std::istream& input, std::ostream& output);
+    ~UciEngine();
+
+    // read and answer commands until quit or end of input
+    void loop();
+
+private:
+    // false once the engine should exit
+    bool handleCommand(const std::string& line);
+    void uci();
+    void setOption(std::istringstream& args);
+    void setPosition(std::istringstream& args);
+    void go(std::istringstream& args);
+    // end any running search and wait until its bestmove has been sent
+    void stopSearch();
+    // the move go ponder expected was played; search on under the clock
+    void ponderHit();
+
+    void send(const std::string& line);
+    // one info line per ranked line of the result
+    std::string infoLine(const SearchResult& result, int lineIndex) const;
+
+    std::istream& _input;
+    std::ostream& _output;
+    std::mutex _outputMutex;
+
+    Position _position;
+    TranspositionTable _transpositionTable;
+    SearchPool _searchPool;
+    int _multiPV;
+    SearchPruning _pruning;
+    PolyglotBook _book;
+    std::mt19937_64 _bookRandom;
+    bool _ownBook;
+
+    // waits for the search and sends bestmove; go infinite holds it back
+    // until stop arrives, and go ponder until stop or ponderhit, as the
+    // protocol requires
+    std::thread _reporter;
+    std::mutex _stopMutex;
+    std::condition_variable _stopCondition;
+    bool _stopRequested;
+    bool _infinite;
+    bool _pondering;
+};
@@ -0,0 +1,34 @@
+#include "Zobrist.h"
+
+namespace {
+    // xorshift64*; a fixed seed keeps keys identical from run to run
+    uint64_t nextRandom(uint64_t& state)
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+}
+
+ZobristKeys::ZobristKeys()
+{
+    uint64_t state = 1070372ULL;
+    for (int piece = 0; piece < 16; ++piece) {
+        for (int square = 0; square < 64; ++square) {
+            pieceSquare[piece][square] = nextRandom(state);
+        }
+    }
+    sideToMove = nextRandom(state);
+    // no rights hashes to nothing, so positions without castling keep
+    // the keys they had before rights were tracked
+    castling[0] = 0ULL;
+    for (int rights = 1; rights < 16; ++rights) {
+        castling[rights] = nextRandom(state);
+    }
+    for (int file = 0; file < 8; ++file) {
+        enPassantFile[file] = nextRandom(state);
+    }
+}
+
+const ZobristKeys zobrist;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// Random keys for incremental 64-bit position hashing. A position's key is
+// the XOR of the key of every piece on its square, plus sideToMove when
+// black is to move, the key for the current set of castling rights and the
+// file of the en passant square if there is one.
+//
+struct ZobristKeys
+{
+    uint64_t pieceSquare[16][64];
+    uint64_t sideToMove;
+    uint64_t castling[16];
+    uint64_t enPassantFile[8];
+
+    ZobristKeys();
+};
+
+extern const ZobristKeys zobrist;
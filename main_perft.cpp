@@ -0,0 +1,360 @@
+// Headless perft runner for the chess move generator.
+//
+//   perft <depth> [fen]             leaf count and nodes/second
+//   perft --divide <depth> [fen]    leaf count under each root move
+//   perft --full <depth> [fen]      make every leaf move instead of bulk counting
+//   perft --suite                   check the standard positions, exit 1 on a mismatch
+//   perft --search-suite            search each of them to a fixed depth; built with
+//                                   CHECK_INCREMENTAL_EVAL, every evaluation is checked
+//   perft --book-suite              check Polyglot keys against the format's reference keys
+//   perft --position-suite          check FEN and EPD reading and writing, and draws by
+//                                   rule, on the engine position
+
+#include "classes/Perft.h"
+#include "classes/MoveGen.h"
+#include "classes/PolyglotBook.h"
+#include "classes/Search.h"
+#include "classes/MagicBitboards.h"
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace {
+    const char* startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // digits only, so a stray option is never read as depth 0
+    bool parseDepth(const std::string& text, int& depth)
+    {
+        if (text.empty() || text[0] < '0' || text[0] > '9') {
+            return false;
+        }
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), depth);
+        return error == std::errc() && end == text.data() + text.size();
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void printRate(uint64_t nodes, double seconds)
+    {
+        double nodesPerSecond = seconds > 0.0 ? static_cast<double>(nodes) / seconds : 0.0;
+        printf("Nodes: %llu  Time: %.3fs  NPS: %.0f\n",
+               static_cast<unsigned long long>(nodes), seconds, nodesPerSecond);
+    }
+
+    int runSuite()
+    {
+        int failures = 0;
+        uint64_t totalNodes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const PerftCase& test : perftSuite()) {
+            Position position;
+            position.setFromFen(test.fen);
+            uint64_t nodes = perft(position, test.depth);
+            totalNodes += nodes;
+            bool passed = nodes == test.nodes;
+            if (!passed) {
+                ++failures;
+            }
+            printf("%s depth %d: %llu (expected %llu) %s\n", test.fen, test.depth,
+                   static_cast<unsigned long long>(nodes),
+                   static_cast<unsigned long long>(test.nodes), passed ? "ok" : "FAILED");
+        }
+        printRate(totalNodes, secondsSince(start));
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    // makes and unmakes through every kind of move the search does, null
+    // moves included, so each leaf evaluation sees the running sums at work
+    constexpr int searchSuiteDepth = 5;
+
+    int runSearchSuite()
+    {
+        TranspositionTable table(16);
+        Search search(table);
+        SearchLimits limits;
+        limits.depth = searchSuiteDepth;
+        uint64_t totalNodes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const PerftCase& test : perftSuite()) {
+            Position position;
+            position.setFromFen(test.fen);
+            table.clear();
+            SearchResult result = search.think(position, limits);
+            totalNodes += result.nodes;
+            printf("%s depth %d: %s score %d\n", test.fen, result.depth, moveToString(result.bestMove).c_str(), result.score);
+        }
+        printRate(totalNodes, secondsSince(start));
+        return EXIT_SUCCESS;
+    }
+
+    // A FEN and what fen() writes back after loading it, or nullptr when
+    // it has to be rejected
+    struct FenCase
+    {
+        const char* fen;
+        const char* written;
+    };
+
+    const char* kiwipeteFen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+
+    const FenCase fenCases[] = {
+        { startFen, startFen },
+        { kiwipeteFen, kiwipeteFen },
+        // the counters may be left off
+        { "4k3/8/8/8/8/8/8/4K3 b - -", "4k3/8/8/8/8/8/8/4K3 b - - 0 1" },
+        // an en passant square stays only when a pawn can take there
+        { "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+          "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3" },
+        { "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2",
+          "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2" },
+        // rights whose rook or king has left home are dropped
+        { "r3k3/8/8/8/8/8/8/4K2R w KQkq - 5 9", "r3k3/8/8/8/8/8/8/4K2R w Kq - 5 9" },
+        { "4k3/8/8/8/8/8/8/4K3 w - - 0 1 garbage here", nullptr },
+        { "8/8/8/8/8/8/8/K7 w - - 0 1", nullptr },
+        { "4k3/8/8/8/8/8/8/K3K3 w - - 0 1", nullptr },
+        { "4k3/8/8/8/8/8/8/4R1K1 w - - 0 1", nullptr },
+        { "4k3/8/8/8/8/8/8/4K3 w - e3 0 1", nullptr },
+        { "4k3/8/8/8/8/8/8/4K3 w - e9 0 1", nullptr },
+        { "4k3/8/8/8/8/8/8/4K3 w X - 0 1", nullptr },
+        { "4k3/8/8/8/8/8/8/4K3 x - - 0 1", nullptr },
+        { "4k3/8/8/8/8/8/4K3 w - - 0 1", nullptr },
+        { "4k3/8/8/8/8/8/8/4K3 w - - -1 1", nullptr },
+        { "", nullptr },
+    };
+
+    // An EPD, what epd() writes back with the operations read from it,
+    // and the FEN the counters operations leave, or nullptr when rejected
+    struct EpdCase
+    {
+        const char* epd;
+        const char* written;
+        const char* fen;
+    };
+
+    const EpdCase epdCases[] = {
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - bm e2a6; id \"kiwi; pete\";",
+          "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - bm e2a6; id \"kiwi; pete\";",
+          kiwipeteFen },
+        { "4k3/8/8/8/8/8/8/4K3 b - - hmvc 12; fmvn 40;", "4k3/8/8/8/8/8/8/4K3 b - - hmvc 12; fmvn 40;",
+          "4k3/8/8/8/8/8/8/4K3 b - - 12 40" },
+        { "4k3/8/8/8/8/8/8/4K3 b - - hmvc x;", nullptr, nullptr },
+        { "8/8/8/8/8/8/8/K7 w - - id \"no king\";", nullptr, nullptr },
+    };
+
+    bool checkFen(const FenCase& test)
+    {
+        Position position;
+        const bool loaded = position.setFromFen(test.fen);
+        if (!test.written) {
+            return !loaded && position.occupancy() == 0;
+        }
+        return loaded && position.fen() == test.written && position.key() == position.computeKey();
+    }
+
+    bool checkEpd(const EpdCase& test)
+    {
+        Position position;
+        EpdOperations operations;
+        const bool loaded = position.setFromEpd(test.epd, &operations);
+        if (!test.written) {
+            return !loaded && position.occupancy() == 0;
+        }
+        return loaded && position.epd(operations) == test.written && position.fen() == test.fen;
+    }
+
+    // moves played from fen, and whether the game is then drawn by rule
+    struct DrawCase
+    {
+        const char* fen;
+        const char* moves;
+        bool draw;
+    };
+
+    const DrawCase drawCases[] = {
+        // the knights shuffle back to the start position for the third time
+        { startFen, "g1f3 g8f6 f3g1 f6g8 g1f3 g8f6 f3g1", false },
+        { startFen, "g1f3 g8f6 f3g1 f6g8 g1f3 g8f6 f3g1 f6g8", true },
+        // no black pawn can take on e3, so the position after 1.e4 repeats
+        { startFen, "e2e4 g8f6 g1f3 f6g8 f3g1 g8f6 g1f3 f6g8", false },
+        { startFen, "e2e4 g8f6 g1f3 f6g8 f3g1 g8f6 g1f3 f6g8 f3g1", true },
+        // the hundredth quiet ply, unless it mates
+        { "8/8/8/8/8/4k3/8/4K2R w - - 98 80", "h1h2", false },
+        { "8/8/8/8/8/4k3/8/4K2R w - - 99 80", "h1h2", true },
+        { "7k/8/6K1/8/8/8/8/R7 w - - 99 80", "a1a8", false },
+    };
+
+    // space separated moves in coordinate notation; false at the first
+    // one that isn't legal
+    bool playMoves(Position& position, std::string_view moves)
+    {
+        while (!moves.empty()) {
+            const size_t space = moves.find(' ');
+            const BitMove move = moveFromString(position, moves.substr(0, space));
+            if (move.isNull()) {
+                return false;
+            }
+            position.makeMove(move);
+            moves = space == std::string_view::npos ? std::string_view() : moves.substr(space + 1);
+        }
+        return true;
+    }
+
+    bool checkDraw(const DrawCase& test)
+    {
+        Position position;
+        return position.setFromFen(test.fen) && playMoves(position, test.moves) && position.isDraw(0) == test.draw;
+    }
+
+    int runPositionSuite()
+    {
+        int failures = 0;
+        for (const FenCase& test : fenCases) {
+            const bool passed = checkFen(test);
+            if (!passed) {
+                ++failures;
+            }
+            printf("fen \"%s\": %s %s\n", test.fen, test.written ? "loads" : "rejected", passed ? "ok" : "FAILED");
+        }
+        for (const EpdCase& test : epdCases) {
+            const bool passed = checkEpd(test);
+            if (!passed) {
+                ++failures;
+            }
+            printf("epd \"%s\": %s %s\n", test.epd, test.written ? "loads" : "rejected", passed ? "ok" : "FAILED");
+        }
+        for (const DrawCase& test : drawCases) {
+            const bool passed = checkDraw(test);
+            if (!passed) {
+                ++failures;
+            }
+            printf("%s moves %s: %s %s\n", test.fen, test.moves, test.draw ? "draw" : "no draw", passed ? "ok" : "FAILED");
+        }
+
+        // round trips of a busy position, for a parse and write rate
+        constexpr int roundTrips = 100000;
+        Position position;
+        size_t written = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < roundTrips; ++i) {
+            position.setFromFen(kiwipeteFen);
+            written += position.fen().size();
+        }
+        const double seconds = secondsSince(start);
+        printf("%d FEN parse and write round trips (%zu characters) in %.3fs: %.0f per second\n",
+               roundTrips, written, seconds, seconds > 0.0 ? roundTrips / seconds : 0.0);
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    // The reference keys published with the Polyglot book format, for
+    // moves from the start position. No pawn can take on e3 after e2e4,
+    // so its file stays out of the key; after f7f5 and c2c4 one can, and
+    // the file goes in.
+    struct BookKeyCase
+    {
+        const char* moves;
+        uint64_t key;
+    };
+
+    const BookKeyCase bookKeyCases[] = {
+        { "", 0x463b96181691fc9cULL },
+        { "e2e4", 0x823c9b50fd114196ULL },
+        { "e2e4 d7d5", 0x0756b94461c50fb0ULL },
+        { "e2e4 d7d5 e4e5", 0x662fafb965db29d4ULL },
+        { "e2e4 d7d5 e4e5 f7f5", 0x22a48b5a8e47ff78ULL },
+        { "e2e4 d7d5 e4e5 f7f5 e1e2", 0x652a607ca3f242c1ULL },
+        { "e2e4 d7d5 e4e5 f7f5 e1e2 e8f7", 0x00fdd303c946bdd9ULL },
+        { "a2a4 b7b5 h2h4 b5b4 c2c4", 0x3c8123ea7b067637ULL },
+        { "a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5c3f9b829b279560ULL },
+    };
+
+    int runBookSuite()
+    {
+        int failures = 0;
+        for (const BookKeyCase& test : bookKeyCases) {
+            Position position;
+            position.setFromFen(startFen);
+            const bool played = playMoves(position, test.moves);
+            const uint64_t key = played ? polyglotKey(position) : 0;
+            const bool passed = played && key == test.key;
+            if (!passed) {
+                ++failures;
+            }
+            printf("moves \"%s\": %016llx (expected %016llx) %s\n", test.moves, static_cast<unsigned long long>(key),
+                   static_cast<unsigned long long>(test.key), passed ? "ok" : "FAILED");
+        }
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    int usage()
+    {
+        fprintf(stderr, "usage: perft [--divide] [--full] <depth> [fen]\n"
+                        "       perft --suite\n"
+                        "       perft --search-suite\n"
+                        "       perft --position-suite\n"
+                        "       perft --book-suite\n");
+        return EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    initMagicBitboards();
+
+    bool divide = false;
+    bool bulkCounting = true;
+    int depth = -1;
+    std::string fen;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--suite") {
+            return runSuite();
+        } else if (arg == "--search-suite") {
+            return runSearchSuite();
+        } else if (arg == "--position-suite") {
+            return runPositionSuite();
+        } else if (arg == "--book-suite") {
+            return runBookSuite();
+        } else if (arg == "--divide") {
+            divide = true;
+        } else if (arg == "--full") {
+            bulkCounting = false;
+        } else if (depth < 0) {
+            if (!parseDepth(arg, depth)) {
+                return usage();
+            }
+        } else {
+            // the FEN may arrive as one quoted argument or as its six fields
+            fen += fen.empty() ? arg : " " + arg;
+        }
+    }
+    if (depth < 0) {
+        return usage();
+    }
+
+    Position position;
+    if (!position.setFromFen(fen.empty() ? startFen : fen)) {
+        fprintf(stderr, "invalid FEN: %s\n", fen.c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+    if (divide) {
+        for (const auto& [move, count] : perftDivide(position, depth, bulkCounting)) {
+            printf("%s: %llu\n", moveToString(move).c_str(), static_cast<unsigned long long>(count));
+            nodes += count;
+        }
+        printf("\n");
+    } else {
+        nodes = perft(position, depth, bulkCounting);
+    }
+    printRate(nodes, secondsSince(start));
+    return EXIT_SUCCESS;
+}
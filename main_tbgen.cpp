@@ -0,0 +1,156 @@
+// Endgame tablebase generator.
+//
+//   tbgen [--threads n] [--verify] <directory> [ending ...]
+//
+// Builds every ending of three and four pieces into directory, or just the
+// named ones (KQvKR) and the smaller endings they lead into. Tables already
+// in the directory are kept and used.
+//
+// --verify then checks every entry of the named endings against a one ply
+// search over the engine's move generator, and their longest mates against
+// the published ones, exiting 1 on any difference.
+
+#include "classes/TablebaseGenerator.h"
+#include "classes/MagicBitboards.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    int usage()
+    {
+        fprintf(stderr, "usage: tbgen [--threads n] [--verify] <directory> [ending ...]\n");
+        return EXIT_FAILURE;
+    }
+
+    // longest wins in plies, from the published tables
+    struct KnownMate
+    {
+        const char* ending;
+        int plies;
+    };
+
+    const KnownMate knownMates[] = {
+        { "KQvK", 19 }, { "KRvK", 31 }, { "KPvK", 55 }, { "KBBvK", 37 }, { "KBNvK", 65 },
+        { "KQvKQ", 25 }, { "KQvKR", 69 }, { "KQvKN", 41 }, { "KRvKR", 37 }, { "KRvKB", 57 }, { "KRvKN", 79 },
+    };
+
+    bool verify(const TablebaseMaterial& material, const Tablebases& tables, int threads)
+    {
+        const std::string name = material.name();
+        TablebaseStats stats;
+        if (!verifyTablebase(material, tables, threads, stats)) {
+            fprintf(stderr, "%s: a table it leads into is missing\n", name.c_str());
+            return false;
+        }
+        int expected = -1;
+        for (const KnownMate& known : knownMates) {
+            if (name == known.ending) {
+                expected = known.plies;
+            }
+        }
+        const bool passed = stats.mismatches == 0 && (expected < 0 || stats.longestMate == expected);
+        printf("%-8s %10llu positions  %10llu wrong  longest mate %3d plies", name.c_str(),
+               static_cast<unsigned long long>(stats.positions), static_cast<unsigned long long>(stats.mismatches),
+               stats.longestMate);
+        if (expected >= 0) {
+            printf(" (published %d)", expected);
+        }
+        printf("  %s\n", passed ? "ok" : "FAILED");
+        fflush(stdout);
+        return passed;
+    }
+
+    // successors first, so every capture and promotion has its table
+    bool generate(const TablebaseMaterial& material, Tablebases& tables, const std::string& directory, int threads)
+    {
+        if (tables.hasTable(material)) {
+            return true;
+        }
+        for (const TablebaseMaterial& successor : tablebaseSuccessors(material)) {
+            if (!generate(successor, tables, directory, threads)) {
+                return false;
+            }
+        }
+
+        const std::string path = (std::filesystem::path(directory) / (material.name() + ".tb")).string();
+        auto start = std::chrono::steady_clock::now();
+        TablebaseStats stats;
+        if (!generateTablebase(material, tables, path, threads, stats) || !tables.load(path)) {
+            fprintf(stderr, "cannot write %s\n", path.c_str());
+            return false;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-8s %10llu positions  %10llu wins  %10llu draws  %10llu losses  longest mate %3d plies  %.1fs\n",
+               material.name().c_str(), static_cast<unsigned long long>(stats.positions),
+               static_cast<unsigned long long>(stats.wins), static_cast<unsigned long long>(stats.draws),
+               static_cast<unsigned long long>(stats.losses), stats.longestMate, seconds);
+        fflush(stdout);
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string directory;
+    std::vector<TablebaseMaterial> endings;
+    bool verifying = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads") {
+            if (i + 1 == argc) {
+                return usage();
+            }
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--verify") {
+            verifying = true;
+        } else if (arg[0] == '-') {
+            // never take an unknown option for the output directory
+            return usage();
+        } else if (directory.empty()) {
+            directory = arg;
+        } else {
+            TablebaseMaterial material;
+            if (!TablebaseMaterial::fromName(arg, material)) {
+                fprintf(stderr, "not an ending of up to %d pieces: %s\n", tablebaseMaxPieces, arg.c_str());
+                return EXIT_FAILURE;
+            }
+            endings.push_back(material);
+        }
+    }
+    if (directory.empty()) {
+        return usage();
+    }
+    if (endings.empty()) {
+        endings = allTablebaseMaterials();
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    initMagicBitboards();
+    Tablebases tables;
+    tables.open(directory);
+
+    bool ok = true;
+    for (const TablebaseMaterial& material : endings) {
+        if (!generate(material, tables, directory, threads)) {
+            ok = false;
+            break;
+        }
+    }
+    for (size_t i = 0; ok && verifying && i < endings.size(); ++i) {
+        if (!verify(endings[i], tables, threads)) {
+            ok = false;
+        }
+    }
+
+    cleanupMagicBitboards();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
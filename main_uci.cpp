@@ -0,0 +1,17 @@
+// Headless UCI chess engine: no window, reads commands on stdin and
+// answers on stdout so it can run under any UCI match manager or GUI.
+
+#include "classes/UciEngine.h"
+#include "classes/MagicBitboards.h"
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    initMagicBitboards();
+
+    UciEngine engine(std::cin, std::cout);
+    engine.loop();
+
+    cleanupMagicBitboards();
+    return 0;
+}